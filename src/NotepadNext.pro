@@ -21,7 +21,7 @@ include(Version.pri)
 
 TEMPLATE = subdirs
 
-SUBDIRS = NotepadNext
+SUBDIRS = NotepadNext tests
 
 
 # Extra Windows targets
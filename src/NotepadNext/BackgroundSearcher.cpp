@@ -0,0 +1,151 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "BackgroundSearcher.h"
+#include "ISearchResultsHandler.h"
+
+
+const int FLUSH_INTERVAL = 100; // Milliseconds between batches of results going to the handler
+
+
+BackgroundSearcher::BackgroundSearcher(QObject *parent) :
+    QObject(parent)
+{
+    flushTimer.setInterval(FLUSH_INTERVAL);
+    connect(&flushTimer, &QTimer::timeout, this, &BackgroundSearcher::flush);
+}
+
+BackgroundSearcher::~BackgroundSearcher()
+{
+    waitForTasks();
+}
+
+void BackgroundSearcher::stop()
+{
+    if (running) {
+        cancel();
+        pool.waitForDone();
+        finishSearch();
+    }
+}
+
+void BackgroundSearcher::cancel()
+{
+    cancelled = true;
+}
+
+bool BackgroundSearcher::begin(const QString &text, int searchFlags, ISearchResultsHandler *handler)
+{
+    auto newSearcher = std::make_unique<const TextSearcher>(text, searchFlags);
+
+    if (!newSearcher->isValid()) {
+        return false;
+    }
+
+    stop();
+
+    searcher = std::move(newSearcher);
+    this->handler = handler;
+    running = true;
+    generation++;
+    matched = 0;
+
+    cancelled = false;
+    searched = 0;
+    skipped = 0;
+
+    // Held on to until finishQueueing(), so the count can't get to 0 before everything has been queued
+    remaining = 1;
+
+    timer.start();
+    flushTimer.start();
+
+    return true;
+}
+
+void BackgroundSearcher::queueTask(const std::function<void()> &task)
+{
+    remaining++;
+
+    pool.start([=]() {
+        // Anything still queued up once it is cancelled just needs to be counted off
+        if (!cancelled) {
+            task();
+        }
+
+        taskDone();
+    });
+}
+
+void BackgroundSearcher::finishQueueing()
+{
+    taskDone();
+}
+
+void BackgroundSearcher::waitForTasks()
+{
+    // The handler may already be gone, so just make sure nothing is still running
+    cancelled = true;
+    pool.waitForDone();
+}
+
+void BackgroundSearcher::reportMatches(const QVector<LineMatches> &lines)
+{
+    for (const LineMatches &line : lines) {
+        for (const auto &range : line.ranges) {
+            handler->newResultsEntry(line.text, line.lineNumber, range.first, range.second);
+        }
+    }
+}
+
+void BackgroundSearcher::taskDone()
+{
+    if (--remaining == 0) {
+        // A new search can't start until every task of this one is done, so this is still the current one
+        const int searchGeneration = generation;
+
+        QMetaObject::invokeMethod(this, [=]() {
+            if (searchGeneration == generation) {
+                finishSearch();
+            }
+        }, Qt::QueuedConnection);
+    }
+}
+
+void BackgroundSearcher::flush()
+{
+    flushResults();
+
+    emit progress(searched, matched);
+}
+
+void BackgroundSearcher::finishSearch()
+{
+    flushTimer.stop();
+
+    // Subclasses can tell this is the last of the results by it no longer running
+    running = false;
+    flush();
+
+    handler->completeSearch();
+
+    qInfo("Searched %d items (skipped %d) in %lld ms%s", searched.load(), skipped.load(), timer.elapsed(), cancelled ? " before being cancelled" : "");
+
+    emit finished(cancelled);
+}
@@ -0,0 +1,101 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BACKGROUNDSEARCHER_H
+#define BACKGROUNDSEARCHER_H
+
+#include "TextSearcher.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+
+class ISearchResultsHandler;
+
+// Runs a search over lots of text at once on a pool of threads, and hands what is found to a results handler
+// in batches on the GUI thread while it is still going. Subclasses decide what gets searched and how it is reported.
+class BackgroundSearcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BackgroundSearcher(QObject *parent = nullptr);
+    ~BackgroundSearcher() override;
+
+    bool isRunning() const { return running; }
+
+    // How many were left out of the last search because they were too big to search
+    int skippedCount() const { return skipped; }
+
+    // Waits for the search to wind down, so the handler has had completeSearch() by the time this returns
+    void stop();
+
+public slots:
+    void cancel();
+
+signals:
+    void progress(int searched, int matched);
+    void finished(bool cancelled);
+
+protected:
+    // Stops any search still going and gets ready for a new one. Returns false if the text can't be searched for.
+    // The handler should already have had newSearch() called, completeSearch() is called once this one is finished.
+    bool begin(const QString &text, int searchFlags, ISearchResultsHandler *handler);
+
+    // The search can't finish until finishQueueing() is called, even if every task queued so far is done
+    void queueTask(const std::function<void()> &task);
+    void finishQueueing();
+
+    // Called on the GUI thread to pass along whatever has been found since last time
+    virtual void flushResults() = 0;
+
+    // Subclasses need to call this from their destructor, since the tasks may be using their members
+    void waitForTasks();
+
+    void reportMatches(const QVector<LineMatches> &lines);
+
+    QThreadPool pool;
+    std::unique_ptr<const TextSearcher> searcher;
+    ISearchResultsHandler *handler = nullptr;
+
+    std::atomic<bool> cancelled{false};
+    std::atomic<int> searched{0};
+    std::atomic<int> skipped{0};
+    int matched = 0;
+
+private:
+    void taskDone();
+    void flush();
+    void finishSearch();
+
+    QTimer flushTimer;
+    QElapsedTimer timer;
+
+    bool running = false;
+    int generation = 0;
+    std::atomic<int> remaining{0};
+};
+
+#endif // BACKGROUNDSEARCHER_H
@@ -110,6 +110,11 @@ QVector<ScintillaNext *> DockedEditor::editors() const
     return editors;
 }
 
+bool DockedEditor::contains(const ScintillaNext *editor) const
+{
+    return ownedEditors.contains(editor);
+}
+
 void DockedEditor::switchToEditor(const ScintillaNext *editor)
 {
     ads::CDockWidget *dockWidget = qobject_cast<ads::CDockWidget *>(editor->parentWidget());
@@ -152,6 +157,9 @@ void DockedEditor::addEditor(ScintillaNext *editor)
         currentEditor = editor;
     }
 
+    ownedEditors.insert(editor);
+    connect(editor, &QObject::destroyed, this, [=]() { ownedEditors.remove(editor); });
+
     emit editorAdded(editor);
 
     // Create the dock widget for the editor
@@ -196,6 +204,14 @@ void DockedEditor::addEditor(ScintillaNext *editor)
         });
     }
 
+    // Show the progress of any background load in the tab
+    connect(editor, &ScintillaNext::loadProgress, dockWidget, [=](int percent) {
+        dockWidget->setWindowTitle(QStringLiteral("%1 (%2%)").arg(editor->getName()).arg(percent));
+    });
+    connect(editor, &ScintillaNext::loadFinished, dockWidget, [=]() {
+        dockWidget->setWindowTitle(editor->getName());
+    });
+
     connect(editor, &ScintillaNext::closed, dockWidget, &ads::CDockWidget::closeDockWidget);
     connect(editor, &ScintillaNext::closed, this, [=]() { emit editorClosed(editor); });
     connect(editor, &ScintillaNext::renamed, this, [=]() { editorRenamed(editor); });
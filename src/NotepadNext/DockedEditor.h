@@ -21,6 +21,7 @@
 #define DOCKEDEDITOR_H
 
 #include <QObject>
+#include <QSet>
 
 #include "DockManager.h"
 #include "ScintillaNext.h"
@@ -32,6 +33,7 @@ class DockedEditor : public QObject
 private:
     ads::CDockManager* dockManager = Q_NULLPTR;
     ScintillaNext *currentEditor = Q_NULLPTR;
+    QSet<const ScintillaNext *> ownedEditors;
 
 public:
     explicit DockedEditor(QWidget *parent);
@@ -40,6 +42,7 @@ public:
     ads::CDockAreaWidget *currentDockArea() const;
 
     QVector<ScintillaNext *> editors() const;
+    bool contains(const ScintillaNext *editor) const;
 
     void switchToEditor(const ScintillaNext *editor);
 
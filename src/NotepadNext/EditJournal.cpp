@@ -0,0 +1,172 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "EditJournal.h"
+#include "ScintillaNext.h"
+
+#include <QFile>
+#include <QThreadPool>
+#include <QtEndian>
+
+
+const int FLUSH_INTERVAL = 100;
+
+const char INSERT_RECORD = 'I';
+const char DELETE_RECORD = 'D';
+const int RECORD_HEADER_SIZE = 1 + 2 * sizeof(qint64); // Type, position, length
+
+
+// Writes for every journal go through one thread so they are appended in the order they were made
+static QThreadPool *journalPool()
+{
+    static QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    return &pool;
+}
+
+EditJournal::EditJournal(ScintillaNext *editor) :
+    QObject(editor)
+{
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(FLUSH_INTERVAL);
+
+    connect(&flushTimer, &QTimer::timeout, this, &EditJournal::flush);
+
+    connect(editor, &ScintillaNext::modified, this, [=](Scintilla::ModificationFlags type, Scintilla::Position position, Scintilla::Position length, Scintilla::Position linesAdded, const QByteArray &text) {
+        Q_UNUSED(linesAdded);
+
+        if (FlagSet(type, Scintilla::ModificationFlags::InsertText)) {
+            record(INSERT_RECORD, position, length, text.constData());
+        }
+        else if (FlagSet(type, Scintilla::ModificationFlags::DeleteText)) {
+            record(DELETE_RECORD, position, length, Q_NULLPTR);
+        }
+    });
+}
+
+void EditJournal::setFilePath(const QString &filePath)
+{
+    this->filePath = filePath;
+
+    pending.clear();
+    flushTimer.stop();
+}
+
+void EditJournal::record(char type, qint64 position, qint64 length, const char *text)
+{
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    // This happens on every keystroke, so it only gets tacked on to a buffer here
+    char header[RECORD_HEADER_SIZE];
+    header[0] = type;
+    qToLittleEndian<qint64>(position, header + 1);
+    qToLittleEndian<qint64>(length, header + 1 + sizeof(qint64));
+
+    pending.append(header, RECORD_HEADER_SIZE);
+
+    if (type == INSERT_RECORD) {
+        pending.append(text, static_cast<int>(length));
+    }
+
+    if (!flushTimer.isActive()) {
+        flushTimer.start();
+    }
+}
+
+void EditJournal::flush()
+{
+    if (pending.isEmpty()) {
+        return;
+    }
+
+    const QString path = filePath;
+    const QByteArray data = pending;
+    pending.clear();
+
+    journalPool()->start([=]() {
+        QFile file(path);
+
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qWarning("Unable to open journal \"%s\": %s", qUtf8Printable(path), qUtf8Printable(file.errorString()));
+            return;
+        }
+
+        if (file.write(data) != data.size()) {
+            qWarning("Unable to write journal \"%s\": %s", qUtf8Printable(path), qUtf8Printable(file.errorString()));
+        }
+
+        file.close();
+    });
+}
+
+int EditJournal::replay(const QString &filePath, ScintillaNext *editor)
+{
+    QFile file(filePath);
+
+    if (!file.exists()) {
+        return 0;
+    }
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning("Unable to open journal \"%s\": %s", qUtf8Printable(filePath), qUtf8Printable(file.errorString()));
+        return 0;
+    }
+
+    const QByteArray data = file.readAll();
+    file.close();
+
+    const char *p = data.constData();
+    const char *end = p + data.size();
+    int count = 0;
+
+    while (end - p >= RECORD_HEADER_SIZE) {
+        const char type = p[0];
+        const qint64 position = qFromLittleEndian<qint64>(p + 1);
+        const qint64 length = qFromLittleEndian<qint64>(p + 1 + sizeof(qint64));
+        const char *text = p + RECORD_HEADER_SIZE;
+
+        if (position < 0 || length < 0 || position > editor->length()) {
+            break;
+        }
+
+        if (type == INSERT_RECORD && length <= end - text) {
+            // The text can have nulls in it so it needs inserted with an explicit length
+            editor->setTargetRange(position, position);
+            editor->replaceTarget(length, text);
+            p = text + length;
+        }
+        else if (type == DELETE_RECORD && position + length <= editor->length()) {
+            editor->deleteRange(position, length);
+            p = text;
+        }
+        else {
+            break;
+        }
+
+        count++;
+    }
+
+    if (p != end) {
+        qWarning("Journal \"%s\" has %lld bytes at the end that could not be replayed", qUtf8Printable(filePath), static_cast<qint64>(end - p));
+    }
+
+    return count;
+}
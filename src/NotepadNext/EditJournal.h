@@ -0,0 +1,58 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include <QObject>
+#include <QTimer>
+
+
+class ScintillaNext;
+
+// Records every insert and delete made to an editor by appending it to a journal file, so that text which
+// has not made it into a session file yet can be recovered after a crash by replaying the journal on top
+// of it. The file is only ever appended to and the writing is done on a worker thread.
+class EditJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EditJournal(ScintillaNext *editor);
+
+    // Anything not written yet is dropped, e.g. because the text it belongs to was just saved in full
+    void setFilePath(const QString &filePath);
+    QString getFilePath() const { return filePath; }
+
+    // Applies the edits in the journal to the editor. Stops at the first one that does not fit, e.g. one that
+    // was only partly written out before a crash. Returns how many were applied.
+    static int replay(const QString &filePath, ScintillaNext *editor);
+
+private slots:
+    void flush();
+
+private:
+    void record(char type, qint64 position, qint64 length, const char *text);
+
+    QString filePath;
+    QByteArray pending;
+    QTimer flushTimer;
+};
+
+#endif // EDITJOURNAL_H
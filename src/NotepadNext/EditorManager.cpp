@@ -17,6 +17,7 @@
  */
 
 #include <QApplication>
+#include <QDir>
 
 #include "EditorManager.h"
 #include "ScintillaNext.h"
@@ -40,6 +41,29 @@ const int MARK_HIDELINESEND = 22;
 const int MARK_HIDELINESUNDERLINE = 21;
 
 
+static QString PathKey(const QString &path)
+{
+#ifdef Q_OS_WIN
+    return path.toLower();
+#else
+    return path;
+#endif
+}
+
+// Just works on the path itself, the file system isn't touched
+static QString FilePathKey(const QString &filePath)
+{
+    return PathKey(QDir::cleanPath(QFileInfo(filePath).absoluteFilePath()));
+}
+
+// Resolves symbolic links, which means going to the file system. Empty if the file doesn't exist (anymore).
+static QString CanonicalFilePathKey(const QString &filePath)
+{
+    const QString canonicalPath = QFileInfo(filePath).canonicalFilePath();
+
+    return canonicalPath.isEmpty() ? QString() : PathKey(canonicalPath);
+}
+
 static int DefaultFontSize()
 {
     QFont font = QApplication::font();
@@ -78,28 +102,66 @@ ScintillaNext *EditorManager::createEditorFromFile(const QString &filePath, bool
     return editor;
 }
 
+ScintillaNext *EditorManager::createEditorFromFileInBackground(const QString &filePath)
+{
+    ScintillaNext *editor = ScintillaNext::fromFile(filePath, false, &loadPool);
+
+    if (editor) {
+        manageEditor(editor);
+    }
+
+    return editor;
+}
+
+void EditorManager::setMaxConcurrentLoads(int count)
+{
+    loadPool.setMaxThreadCount(qMax(1, count));
+}
+
 ScintillaNext *EditorManager::getEditorByFilePath(const QString &filePath)
 {
-    QFileInfo newInfo(filePath);
-    newInfo.makeAbsolute();
+    // Almost always the path is written the same way as the editor's. Only if it isn't is the file system asked
+    // where it really is, e.g. when it goes through a symbolic link.
+    ScintillaNext *editor = editorsByPath.value(FilePathKey(filePath));
 
-    purgeOldEditorPointers();
+    if (!editor) {
+        const QString canonicalKey = CanonicalFilePathKey(filePath);
 
-    for (ScintillaNext *editor : qAsConst(editors)) {
-        if (editor->isFile() && editor->getFileInfo() == newInfo) {
-            return editor;
+        if (!canonicalKey.isEmpty()) {
+            editor = editorsByPath.value(canonicalKey);
         }
     }
 
+    if (editor && editor->isFile()) {
+        return editor;
+    }
+
     return Q_NULLPTR;
 }
 
 void EditorManager::manageEditor(ScintillaNext *editor)
 {
+    purgeOldEditorPointers();
+
     editors.append(QPointer<ScintillaNext>(editor));
 
+    // Files can come and go from editors, e.g. a new file saved for the first time
+    indexEditor(editor);
+    connect(editor, &ScintillaNext::renamed, this, [=]() { indexEditor(editor); });
+    connect(editor, &ScintillaNext::saved, this, [=]() { indexEditor(editor); });
+    connect(editor, &ScintillaNext::closed, this, [=]() { unindexEditor(editor); });
+    connect(editor, &QObject::destroyed, this, [=]() { unindexEditor(editor); });
+
     setupEditor(editor);
 
+    // Placeholders may never be looked at, so the decorators wait until there is some text for them to work on
+    if (editor->isPlaceholder()) {
+        connect(editor, &ScintillaNext::materialized, this, [=]() { setupDecorators(editor); });
+    }
+    else {
+        setupDecorators(editor);
+    }
+
     emit editorCreated(editor);
 }
 
@@ -206,8 +268,12 @@ void EditorManager::setupEditor(ScintillaNext *editor)
     // STYLE_CONTROLCHAR
     // STYLE_CALLTIP
     // STYLE_FOLDDISPLAYTEXT
+}
+
+void EditorManager::setupDecorators(ScintillaNext *editor)
+{
+    qInfo(Q_FUNC_INFO);
 
-    // Decorators
     SmartHighlighter *s = new SmartHighlighter(editor);
     s->setEnabled(true);
 
@@ -217,8 +283,9 @@ void EditorManager::setupEditor(ScintillaNext *editor)
     BraceMatch *b = new BraceMatch(editor);
     b->setEnabled(true);
 
+    // Paged files put the line numbers of the whole file in the margin themselves
     LineNumbers *l = new LineNumbers(editor);
-    l->setEnabled(true);
+    l->setEnabled(!editor->isPaged());
 
     SurroundSelection *ss = new SurroundSelection(editor);
     ss->setEnabled(true);
@@ -237,6 +304,16 @@ void EditorManager::setupEditor(ScintillaNext *editor)
 
     BookMarkDecorator *bm = new BookMarkDecorator(editor);
     bm->setEnabled(true);
+
+    // These search the entire document any time the text or selection changes, which does not scale to large files
+    connect(editor, &ScintillaNext::loadFinished, s, [=]() {
+        if (editor->isLargeFile()) {
+            qInfo("Disabling whole document decorators for \"%s\"", qUtf8Printable(editor->getName()));
+
+            s->setEnabled(false);
+            ac->setEnabled(false);
+        }
+    });
 }
 
 void EditorManager::purgeOldEditorPointers()
@@ -249,3 +326,38 @@ void EditorManager::purgeOldEditorPointers()
             it.remove();
     }
 }
+
+void EditorManager::indexEditor(ScintillaNext *editor)
+{
+    unindexEditor(editor);
+
+    if (editor->isFile()) {
+        const QString filePath = editor->getFileInfo().absoluteFilePath();
+        QStringList keys = {FilePathKey(filePath)};
+
+        // The file system is only asked here, when the editor's file changes, so lookups through a symbolic link
+        // still find it
+        const QString canonicalKey = CanonicalFilePathKey(filePath);
+        if (!canonicalKey.isEmpty() && canonicalKey != keys.first()) {
+            keys.append(canonicalKey);
+        }
+
+        for (const QString &key : keys) {
+            editorsByPath.insert(key, editor);
+        }
+
+        indexedPaths.insert(editor, keys);
+    }
+}
+
+void EditorManager::unindexEditor(ScintillaNext *editor)
+{
+    const QStringList keys = indexedPaths.take(editor);
+
+    // Another editor may have been indexed under the same path since
+    for (const QString &key : keys) {
+        if (editorsByPath.value(key) == editor) {
+            editorsByPath.remove(key);
+        }
+    }
+}
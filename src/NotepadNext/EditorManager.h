@@ -20,8 +20,11 @@
 #ifndef EDITORMANAGER_H
 #define EDITORMANAGER_H
 
+#include <QHash>
 #include <QObject>
 #include <QPointer>
+#include <QStringList>
+#include <QThreadPool>
 
 
 class ScintillaNext;
@@ -36,6 +39,11 @@ public:
     ScintillaNext *createEditor(const QString &name);
     ScintillaNext *createEditorFromFile(const QString &filePath, bool tryToCreate=false);
 
+    // The editor is created right away but the file is read on the loading pool, so many files can be read at once
+    ScintillaNext *createEditorFromFileInBackground(const QString &filePath);
+    void setMaxConcurrentLoads(int count);
+
+    // Different spellings of the same file (relative, symlinked, etc) all find the same editor
     ScintillaNext *getEditorByFilePath(const QString &filePath);
 
     void manageEditor(ScintillaNext *editor);
@@ -46,9 +54,15 @@ signals:
 
 private:
     void setupEditor(ScintillaNext *editor);
+    void setupDecorators(ScintillaNext *editor);
     void purgeOldEditorPointers();
+    void indexEditor(ScintillaNext *editor);
+    void unindexEditor(ScintillaNext *editor);
 
     QList<QPointer<ScintillaNext>> editors;
+    QHash<QString, ScintillaNext *> editorsByPath;
+    QHash<ScintillaNext *, QStringList> indexedPaths; // The keys each editor is indexed under
+    QThreadPool loadPool;
 };
 
 #endif // EDITORMANAGER_H
@@ -0,0 +1,106 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "EditorViewState.h"
+#include "ScintillaNext.h"
+#include "BookMarkDecorator.h"
+
+#include <algorithm>
+
+
+EditorViewState EditorViewState::capture(ScintillaNext *editor)
+{
+    EditorViewState view;
+
+    view.firstVisibleLine = editor->firstVisibleLine();
+    view.currentPosition = editor->currentPos();
+
+    for (int i = 0; i < editor->selections(); ++i) {
+        view.selections.append(qMakePair<qint64, qint64>(editor->selectionNCaret(i), editor->selectionNAnchor(i)));
+    }
+    view.mainSelection = editor->mainSelection();
+
+    for (Sci_Position line = editor->contractedFoldNext(0); line != -1; line = editor->contractedFoldNext(line + 1)) {
+        view.foldedLines.append(line);
+    }
+
+    BookMarkDecorator *bookmarks = editor->findChild<BookMarkDecorator *>(QString(), Qt::FindDirectChildrenOnly);
+    if (bookmarks) {
+        for (int line : bookmarks->bookmarkedLines()) {
+            view.bookmarkedLines.append(line);
+        }
+    }
+
+    return view;
+}
+
+void EditorViewState::apply(ScintillaNext *editor) const
+{
+    const Sci_Position length = editor->length();
+    const Sci_Position lineCount = editor->lineCount();
+
+    // Fold levels come from the lexer, so it needs to have gone over everything up to the last folded line
+    if (!foldedLines.isEmpty()) {
+        const Sci_Position lastFoldedLine = *std::max_element(foldedLines.constBegin(), foldedLines.constEnd());
+
+        editor->colourise(0, editor->lineEndPosition(qMin(lastFoldedLine + 1, lineCount - 1)));
+
+        for (qint64 line : foldedLines) {
+            if (line < lineCount && (editor->foldLevel(line) & SC_FOLDLEVELHEADERFLAG)) {
+                editor->foldLine(line, SC_FOLDACTION_CONTRACT);
+            }
+        }
+    }
+
+    BookMarkDecorator *bookmarks = editor->findChild<BookMarkDecorator *>(QString(), Qt::FindDirectChildrenOnly);
+    if (bookmarks && !bookmarkedLines.isEmpty()) {
+        QList<int> lines;
+
+        for (qint64 line : bookmarkedLines) {
+            if (line < lineCount) {
+                lines.append(static_cast<int>(line));
+            }
+        }
+
+        bookmarks->setBookmarkedLines(lines);
+    }
+
+    if (selections.isEmpty()) {
+        editor->setEmptySelection(qMin<Sci_Position>(currentPosition, length));
+    }
+    else {
+        for (int i = 0; i < selections.size(); ++i) {
+            const Sci_Position caret = qMin<Sci_Position>(selections.at(i).first, length);
+            const Sci_Position anchor = qMin<Sci_Position>(selections.at(i).second, length);
+
+            if (i == 0) {
+                editor->setSelection(caret, anchor);
+            }
+            else {
+                editor->addSelection(caret, anchor);
+            }
+        }
+
+        if (mainSelection < selections.size()) {
+            editor->setMainSelection(mainSelection);
+        }
+    }
+
+    editor->setFirstVisibleLine(firstVisibleLine);
+}
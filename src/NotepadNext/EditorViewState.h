@@ -0,0 +1,49 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EDITORVIEWSTATE_H
+#define EDITORVIEWSTATE_H
+
+#include <QPair>
+#include <QVector>
+
+
+class QDataStream;
+class ScintillaNext;
+
+// Where an editor was looking and what the user had set up in it, so it can be put back the same way
+struct EditorViewState
+{
+    static EditorViewState capture(ScintillaNext *editor);
+
+    // The lexer needs to already be set up on the editor for the folds to be put back
+    void apply(ScintillaNext *editor) const;
+
+    qint64 firstVisibleLine = 0;
+    qint64 currentPosition = 0;
+    QVector<QPair<qint64, qint64>> selections; // Caret and anchor of each selection
+    qint32 mainSelection = 0;
+    QVector<qint64> foldedLines;
+    QVector<qint64> bookmarkedLines;
+};
+
+QDataStream &operator<<(QDataStream &stream, const EditorViewState &state);
+QDataStream &operator>>(QDataStream &stream, EditorViewState &state);
+
+#endif // EDITORVIEWSTATE_H
@@ -0,0 +1,262 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "FileAnalyzer.h"
+#include "Scintilla.h"
+#include "Utf8Validator.h"
+
+#include "uchardet.h"
+
+#include <QTextCodec>
+
+#include <cstring>
+
+
+const int MIN_INDENTED_LINES = 5; // Don't guess the indentation from just a line or two
+const int BINARY_NUL_PERCENT = 1; // Text files practically never contain NUL bytes
+
+
+// memchr() is vectorized by every C library that matters, so lean on it rather than looping over every byte
+static qint64 countByte(const char *data, qint64 length, char c)
+{
+    const char *end = data + length;
+    qint64 count = 0;
+
+    while ((data = static_cast<const char *>(memchr(data, c, end - data))) != nullptr) {
+        count++;
+        data++;
+    }
+
+    return count;
+}
+
+QTextCodec *FileAnalyzer::detectCodec(const QByteArray &head, QByteArray &charset, bool &hasBom)
+{
+    // Search for a BOM mark
+    QTextCodec *codec = QTextCodec::codecForUtfText(head, Q_NULLPTR);
+
+    hasBom = codec != Q_NULLPTR;
+
+    // The head may end part way into a character, which is why the validator is not finished here.
+    // The rest of the file gets validated as it is read.
+    Utf8Validator validator;
+
+    if (codec != Q_NULLPTR) {
+        qDebug("BOM mark found");
+
+        charset = codec->name();
+    }
+    else if (validator.validate(head.constData(), head.size())) {
+        // Valid UTF-8 is very unlikely to be anything else, so there is no need to guess
+        qDebug("BOM mark not found, but the text is valid UTF-8");
+
+        charset = validator.isAscii() ? QByteArrayLiteral("ASCII") : QByteArrayLiteral("UTF-8");
+        codec = QTextCodec::codecForName("UTF-8");
+    }
+    else {
+        qDebug("BOM mark not found, using uchardet");
+
+        // Use uchardet to try and detect file encoding since no BOM was found
+        uchardet_t encodingDetector = uchardet_new();
+        if (uchardet_handle_data(encodingDetector, head.constData(), head.size()) == 0) {
+            uchardet_data_end(encodingDetector);
+
+            qDebug("uchardet detected encoding as: '%s'", uchardet_get_charset(encodingDetector));
+            charset = uchardet_get_charset(encodingDetector);
+            codec = QTextCodec::codecForName(charset);
+        }
+        else {
+            qDebug("uchardet failure");
+        }
+        uchardet_delete(encodingDetector);
+    }
+
+    qDebug("Using codec: '%s'", codec ? codec->name().constData() : "");
+
+    return codec;
+}
+
+bool FileAnalyzer::isUtf8Compatible(const QByteArray &charset)
+{
+    return charset == "UTF-8" || charset == "ASCII";
+}
+
+void FileAnalyzer::analyze(const char *data, qint64 length)
+{
+    if (length <= 0) {
+        return;
+    }
+
+    const char *end = data + length;
+
+    totalBytes += length;
+    lfCount += countByte(data, length, '\n');
+    nulCount += countByte(data, length, '\0');
+
+    // A CR followed by a LF is a CRLF, which can be split across two chunks
+    if (endsWithCR && data[0] == '\n') {
+        crlfCount++;
+    }
+
+    for (const char *cr = data; (cr = static_cast<const char *>(memchr(cr, '\r', end - cr))) != nullptr; ++cr) {
+        crCount++;
+
+        if (cr + 1 < end && cr[1] == '\n') {
+            crlfCount++;
+        }
+    }
+
+    endsWithCR = end[-1] == '\r';
+
+    // Only the beginning of each line matters for the indentation, so jump from one LF to the next.
+    // NOTE: Files using just CR for line endings only get their first line looked at.
+    const char *p = data;
+
+    while (p < end) {
+        if (inLeadingWhitespace) {
+            while (p < end && (*p == ' ' || *p == '\t')) {
+                if (*p == ' ') {
+                    leadingSpaces++;
+                }
+                else if (leadingSpaces == 0) {
+                    leadingTab = true;
+                }
+                p++;
+            }
+
+            // The whitespace continues on into the next chunk
+            if (p == end) {
+                break;
+            }
+
+            finishLeadingWhitespace(*p);
+        }
+
+        p = static_cast<const char *>(memchr(p, '\n', end - p));
+
+        if (p == nullptr) {
+            break;
+        }
+
+        p++;
+        inLeadingWhitespace = true;
+        leadingSpaces = 0;
+        leadingTab = false;
+    }
+}
+
+void FileAnalyzer::finishLeadingWhitespace(char nextChar)
+{
+    inLeadingWhitespace = false;
+
+    // Blank lines say nothing about the indentation
+    if (nextChar == '\r' || nextChar == '\n') {
+        return;
+    }
+
+    if (leadingTab) {
+        tabIndentedLines++;
+    }
+    else if (leadingSpaces > 0) {
+        spaceIndentedLines++;
+    }
+
+    if (!leadingTab) {
+        const int delta = qAbs(leadingSpaces - previousIndent);
+
+        if (delta > 0 && delta < static_cast<int>(indentDeltas.size())) {
+            indentDeltas[delta]++;
+        }
+
+        previousIndent = leadingSpaces;
+    }
+}
+
+void FileAnalyzer::setEncoding(QTextCodec *codec, bool hasBom)
+{
+    textCodec = codec;
+    bom = hasBom;
+}
+
+void FileAnalyzer::setFirstInvalidUtf8Offset(qint64 offset)
+{
+    invalidUtf8Offset = offset;
+}
+
+qint64 FileAnalyzer::lineCount() const
+{
+    return lfCount + (crCount - crlfCount) + 1;
+}
+
+qint64 FileAnalyzer::estimateLineCount(qint64 totalBytes) const
+{
+    if (this->totalBytes == 0) {
+        return 1;
+    }
+
+    return static_cast<qint64>(static_cast<double>(lineCount()) / this->totalBytes * totalBytes);
+}
+
+int FileAnalyzer::eolMode() const
+{
+    const qint64 lfOnly = lfCount - crlfCount;
+    const qint64 crOnly = crCount - crlfCount;
+
+    if (crlfCount == 0 && lfOnly == 0 && crOnly == 0) {
+        return -1;
+    }
+    else if (crlfCount >= lfOnly && crlfCount >= crOnly) {
+        return SC_EOL_CRLF;
+    }
+    else if (lfOnly >= crOnly) {
+        return SC_EOL_LF;
+    }
+    else {
+        return SC_EOL_CR;
+    }
+}
+
+bool FileAnalyzer::isBinary() const
+{
+    return nulCount > 0 && nulCount * 100 >= totalBytes * BINARY_NUL_PERCENT;
+}
+
+bool FileAnalyzer::hasIndentation() const
+{
+    return tabIndentedLines + spaceIndentedLines >= MIN_INDENTED_LINES;
+}
+
+bool FileAnalyzer::usesTabs() const
+{
+    return tabIndentedLines > spaceIndentedLines;
+}
+
+int FileAnalyzer::indentSize() const
+{
+    int bestSize = 0;
+
+    // Ties go to the larger size
+    for (int size = 1; size < static_cast<int>(indentDeltas.size()); ++size) {
+        if (indentDeltas[size] > 0 && indentDeltas[size] >= indentDeltas[bestSize]) {
+            bestSize = size;
+        }
+    }
+
+    return bestSize;
+}
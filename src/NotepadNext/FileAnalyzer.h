@@ -0,0 +1,94 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FILEANALYZER_H
+#define FILEANALYZER_H
+
+#include <QByteArray>
+
+#include <array>
+
+
+class QTextCodec;
+
+// Works out the properties of a file (encoding, line endings, indentation, etc) while it is being read,
+// so that nothing needs to make another pass over the text afterwards.
+class FileAnalyzer
+{
+public:
+    // Determines the encoding by looking at the first few bytes of a file. Returns the name of the
+    // character set and the codec to decode it with, which may be null if no transcoding is possible.
+    static QTextCodec *detectCodec(const QByteArray &head, QByteArray &charset, bool &hasBom);
+
+    // Whether the bytes of the character set can go straight into a document without being converted
+    static bool isUtf8Compatible(const QByteArray &charset);
+
+    // Feed the UTF-8 text exactly as it is being added to the document
+    void analyze(const char *data, qint64 length);
+
+    // What the text was converted from while reading it. The codec is null when the bytes were used as is.
+    void setEncoding(QTextCodec *codec, bool hasBom);
+    QTextCodec *codec() const { return textCodec; }
+    bool hasBom() const { return bom; }
+
+    // Where the text read as UTF-8 turned out not to be, or -1 if it was fine
+    void setFirstInvalidUtf8Offset(qint64 offset);
+    qint64 firstInvalidUtf8Offset() const { return invalidUtf8Offset; }
+
+    qint64 lineCount() const;
+    qint64 estimateLineCount(qint64 totalBytes) const;
+
+    // The most common line ending as a SC_EOL_* value, or -1 if there are no line endings at all
+    int eolMode() const;
+
+    bool isBinary() const;
+
+    // Whether enough indented lines were seen to say anything about the indentation
+    bool hasIndentation() const;
+    bool usesTabs() const;
+    int indentSize() const; // 0 if it could not be determined
+
+private:
+    void finishLeadingWhitespace(char nextChar);
+
+    QTextCodec *textCodec = nullptr;
+    bool bom = false;
+    qint64 invalidUtf8Offset = -1;
+
+    qint64 totalBytes = 0;
+    qint64 lfCount = 0;
+    qint64 crCount = 0;
+    qint64 crlfCount = 0;
+    qint64 nulCount = 0;
+    bool endsWithCR = false;
+
+    // State of the leading whitespace of the current line, which can span multiple chunks
+    bool inLeadingWhitespace = true;
+    int leadingSpaces = 0;
+    bool leadingTab = false;
+    int previousIndent = 0;
+
+    qint64 tabIndentedLines = 0;
+    qint64 spaceIndentedLines = 0;
+
+    // How often the indentation changed by N spaces from one line to the next
+    std::array<qint64, 9> indentDeltas = {};
+};
+
+#endif // FILEANALYZER_H
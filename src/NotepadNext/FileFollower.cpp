@@ -0,0 +1,136 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "FileFollower.h"
+
+#include <QFile>
+#include <QTextCodec>
+
+
+const int FRAME_INTERVAL = 16; // Roughly one frame at 60Hz
+const int MISSING_FILE_INTERVAL = 500; // How often to look for a file that was moved away to come back
+const qint64 MAX_READ_SIZE = 1024 * 1024 * 4; // Per frame, so a huge burst doesn't lock up the GUI
+
+
+FileFollower::FileFollower(const QString &filePath, qint64 offset, QTextCodec *codec, QObject *parent) :
+    QObject(parent),
+    filePath(filePath),
+    offset(offset),
+    codec(codec)
+{
+    resetDecoder();
+
+    frameTimer.setSingleShot(true);
+
+    connect(&watcher, &QFileSystemWatcher::fileChanged, this, &FileFollower::fileChanged);
+    connect(&frameTimer, &QTimer::timeout, this, &FileFollower::readNewData);
+
+    watcher.addPath(filePath);
+
+    // Catch anything written between the file being read and now
+    frameTimer.start(0);
+}
+
+FileFollower::~FileFollower()
+{
+}
+
+void FileFollower::fileChanged()
+{
+    // Let the writes pile up until the next frame rather than reading after every single one
+    if (!frameTimer.isActive()) {
+        frameTimer.start(FRAME_INTERVAL);
+    }
+}
+
+void FileFollower::readNewData()
+{
+    // The watcher stops watching a file once it is renamed or deleted, which is what happens when a log is rotated
+    if (!watcher.files().contains(filePath)) {
+        if (!QFile::exists(filePath)) {
+            frameTimer.start(MISSING_FILE_INTERVAL);
+            return;
+        }
+
+        qInfo("\"%s\" was replaced, following the new file", qUtf8Printable(filePath));
+
+        watcher.addPath(filePath);
+        restart();
+    }
+
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning("QFile::open() failed when following \"%s\" - error code %d: %s", qUtf8Printable(filePath), file.error(), qUtf8Printable(file.errorString()));
+        return;
+    }
+
+    const qint64 size = file.size();
+
+    if (size < offset) {
+        qInfo("\"%s\" was truncated, reading it again from the start", qUtf8Printable(filePath));
+        restart();
+    }
+
+    if (size == offset || !file.seek(offset)) {
+        return;
+    }
+
+    QByteArray data = file.read(qMin(size - offset, MAX_READ_SIZE));
+
+    if (data.isEmpty()) {
+        return;
+    }
+
+    // A new file may start with a BOM, which is not part of the text
+    if (offset == 0 && !decoder && data.startsWith("\xEF\xBB\xBF")) {
+        data.remove(0, 3);
+    }
+
+    offset = file.pos();
+
+    if (decoder) {
+        emit appended(decoder->toUnicode(data).toUtf8());
+    }
+    else {
+        emit appended(data);
+    }
+
+    // Pick up the rest on the next frame
+    if (offset < size) {
+        frameTimer.start(FRAME_INTERVAL);
+    }
+}
+
+void FileFollower::restart()
+{
+    offset = 0;
+
+    resetDecoder();
+
+    emit restarted();
+}
+
+void FileFollower::resetDecoder()
+{
+    if (codec) {
+        // Only the start of the file can have a BOM, anything that looks like one part way through is text
+        decoder.reset(codec->makeDecoder(offset == 0 ? QTextCodec::DefaultConversion : QTextCodec::IgnoreHeader));
+    }
+}
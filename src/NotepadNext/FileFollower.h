@@ -0,0 +1,71 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FILEFOLLOWER_H
+#define FILEFOLLOWER_H
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QTimer>
+
+#include <memory>
+
+
+class QTextCodec;
+class QTextDecoder;
+
+// Watches a file that keeps growing (e.g. a log) and reads just the bytes that were added to the end
+// of it since last time. Any number of changes within a frame get read in one go.
+class FileFollower : public QObject
+{
+    Q_OBJECT
+
+public:
+    // The offset is how much of the file has already been read. A null codec passes the bytes through as is.
+    explicit FileFollower(const QString &filePath, qint64 offset, QTextCodec *codec, QObject *parent = Q_NULLPTR);
+    ~FileFollower() override;
+
+    qint64 getOffset() const { return offset; }
+
+signals:
+    // New text from the end of the file, converted to UTF-8
+    void appended(const QByteArray &data);
+
+    // The file was truncated or replaced by a new one (e.g. log rotation) so everything read so far is stale.
+    // Reading starts over from the beginning of the file.
+    void restarted();
+
+private slots:
+    void fileChanged();
+    void readNewData();
+
+private:
+    void restart();
+    void resetDecoder();
+
+    const QString filePath;
+    qint64 offset;
+    QTextCodec *codec;
+    std::unique_ptr<QTextDecoder> decoder;
+
+    QFileSystemWatcher watcher;
+    QTimer frameTimer;
+};
+
+#endif // FILEFOLLOWER_H
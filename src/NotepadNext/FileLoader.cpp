@@ -0,0 +1,298 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "FileLoader.h"
+#include "Scintilla.h"
+#include "Utf8Validator.h"
+
+#include <QElapsedTimer>
+#include <QTextCodec>
+
+#if defined(Q_OS_WIN)
+#include <Windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+
+const int CHUNK_SIZE = 1024 * 1024 * 4; // Not sure what is best
+const int DETECTION_SIZE = 1024 * 64;
+
+
+qint64 FileLoader::peakMemoryUsage()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.PeakWorkingSetSize);
+    }
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(Q_OS_MACOS)
+        return usage.ru_maxrss; // Already in bytes
+#else
+        return usage.ru_maxrss * 1024; // Reported in kilobytes
+#endif
+    }
+#endif
+
+    return -1;
+}
+
+// Feeds the file to the handler directly out of memory mapped windows of the file, so the data never
+// gets copied anywhere but the document itself. Returns false if the file could not be mapped at all.
+static bool readMapped(QFile &file, qint64 offset, const FileLoader::DataHandler &handler, bool &keepReading)
+{
+    const qint64 fileSize = file.size();
+
+    keepReading = true;
+
+    while (offset < fileSize && keepReading) {
+        const qint64 length = qMin<qint64>(CHUNK_SIZE, fileSize - offset);
+        uchar *data = file.map(offset, length);
+
+        if (data == Q_NULLPTR) {
+            if (offset == 0) {
+                qDebug("QFile::map() failed, falling back to reading: %s", qUtf8Printable(file.errorString()));
+                return false;
+            }
+
+            qWarning("Something bad happened when mapping disk %d %s", file.error(), qUtf8Printable(file.errorString()));
+            keepReading = false;
+            return true;
+        }
+
+        // Keep the file position in sync with what has been consumed for anyone watching progress
+        offset += length;
+        file.seek(offset);
+
+        keepReading = handler(reinterpret_cast<const char *>(data), length);
+
+        // Unmapping each window as it is finished keeps these pages from counting against the process
+        file.unmap(data);
+    }
+
+    return true;
+}
+
+static bool readDecoded(QFile &file, QTextCodec *codec, const FileLoader::DataHandler &handler)
+{
+    QByteArray chunk;
+    qint64 bytesRead;
+    QTextCodec::ConverterState state;
+    bool keepReading = true;
+
+    do {
+        // Try to read as much as possible
+        chunk.resize(CHUNK_SIZE);
+        bytesRead = file.read(chunk.data(), CHUNK_SIZE);
+        chunk.resize(bytesRead);
+
+        qDebug("Read %lld bytes", bytesRead);
+
+        if (codec) {
+            const QByteArray utf8_data = codec->toUnicode(chunk.constData(), chunk.size(), &state).toUtf8();
+            keepReading = handler(utf8_data.constData(), utf8_data.size());
+        }
+        else {
+            keepReading = handler(chunk.constData(), chunk.size());
+        }
+    } while (!file.atEnd() && keepReading);
+
+    if (bytesRead == -1) {
+        qWarning("Something bad happened when reading disk %d %s", file.error(), qUtf8Printable(file.errorString()));
+        return false;
+    }
+
+    return keepReading;
+}
+
+FileLoader::FileLoader(const QString &filePath, Scintilla::ILoader *loader) :
+    QObject(Q_NULLPTR),
+    filePath(filePath),
+    loader(loader),
+    cancelled(false)
+{
+}
+
+FileLoader::~FileLoader()
+{
+    // The document was never handed over, e.g. the editor was closed right as the load finished
+    if (loader) {
+        loader->Release();
+    }
+}
+
+bool FileLoader::readFile(QFile &file, const DataHandler &handler, FileAnalyzer *analyzer)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // Limit detection to the first 64 kilobytes. Peeking leaves the file position at the start.
+    QByteArray charset;
+    bool hasBom = false;
+    QTextCodec *codec = FileAnalyzer::detectCodec(file.peek(DETECTION_SIZE), charset, hasBom);
+
+    // The analyzer looks at each chunk while it is still hot in the cache, rather than going back over the whole document later
+    const DataHandler analyzingHandler = [&](const char *data, qint64 length) {
+        analyzer->analyze(data, length);
+        return handler(data, length);
+    };
+    const DataHandler &chunkHandler = analyzer ? analyzingHandler : handler;
+
+    bool success = false;
+    bool mapped = false;
+
+    if (FileAnalyzer::isUtf8Compatible(charset)) {
+        // A UTF-8 BOM is the only thing that needs to be skipped, the rest is used as is
+        const qint64 bomLength = file.peek(3) == QByteArrayLiteral("\xEF\xBB\xBF") ? 3 : 0;
+
+        // The document is UTF-8 as well so there is nothing to convert
+        codec = Q_NULLPTR;
+
+        // Only the start of the file was checked, so make sure the rest of it holds up as it goes by
+        Utf8Validator validator;
+        qint64 validationTime = 0;
+        const DataHandler validatingHandler = [&](const char *data, qint64 length) {
+            QElapsedTimer validationTimer;
+            validationTimer.start();
+            validator.validate(data, length);
+            validationTime += validationTimer.nsecsElapsed();
+
+            return chunkHandler(data, length);
+        };
+
+        mapped = readMapped(file, bomLength, validatingHandler, success);
+
+        if (!mapped) {
+            file.seek(bomLength);
+            success = readDecoded(file, Q_NULLPTR, validatingHandler);
+        }
+
+        if (success && !validator.finish()) {
+            // The bytes are still kept exactly as they are, so saving the file does not change them
+            qWarning("\"%s\" is not valid UTF-8 starting at byte %lld", qUtf8Printable(file.fileName()), validator.firstInvalidOffset() + bomLength);
+        }
+
+        if (analyzer) {
+            analyzer->setFirstInvalidUtf8Offset(validator.isValid() ? -1 : validator.firstInvalidOffset() + bomLength);
+        }
+
+        qInfo("Validated %lld bytes of UTF-8 in %lld ms (%.1f MB/s) using %s", validator.bytesValidated(), validationTime / 1000000,
+              validationTime > 0 ? validator.bytesValidated() / (1024.0 * 1024.0) / (validationTime / 1000000000.0) : 0.0,
+              Utf8Validator::implementation());
+    }
+    else {
+        success = readDecoded(file, codec, chunkHandler);
+    }
+
+    if (analyzer) {
+        analyzer->setEncoding(codec, hasBom);
+    }
+
+    qInfo("Read \"%s\" (%lld bytes, %s) in %lld ms using %s, peak memory usage %lld MB",
+          qUtf8Printable(file.fileName()), file.size(), charset.isEmpty() ? "unknown encoding" : charset.constData(),
+          timer.elapsed(), mapped ? "memory mapping" : "buffered reads", peakMemoryUsage() / (1024 * 1024));
+
+    return success;
+}
+
+void FileLoader::start(QThreadPool *pool)
+{
+    pool->start([this]() { run(); });
+}
+
+void FileLoader::cancel()
+{
+    cancelled = true;
+}
+
+bool FileLoader::isCancelled() const
+{
+    return cancelled;
+}
+
+void *FileLoader::takeDocument()
+{
+    Q_ASSERT(loader != Q_NULLPTR);
+
+    void *document = loader->ConvertToDocument();
+    loader = Q_NULLPTR;
+
+    return document;
+}
+
+void FileLoader::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(filePath);
+    bool success = false;
+
+    if (file.open(QIODevice::ReadOnly)) {
+        const qint64 totalBytes = file.size();
+
+        success = readFile(file, [&](const char *data, qint64 length) {
+            if (cancelled) {
+                return false;
+            }
+
+            if (loader->AddData(data, length) != SC_STATUS_OK) {
+                qWarning("ILoader::AddData() failed for \"%s\"", qUtf8Printable(filePath));
+                error = tr("Not enough memory to hold the file");
+                return false;
+            }
+
+            const qint64 bytesRead = file.pos();
+            QMetaObject::invokeMethod(this, [=]() { emit progress(bytesRead, totalBytes); }, Qt::QueuedConnection);
+
+            return true;
+        }, &analyzer);
+
+        if (!success && error.isEmpty()) {
+            error = file.errorString();
+        }
+
+        file.close();
+    }
+    else {
+        qWarning("QFile::open() failed when opening \"%s\" - error code %d: %s", qUtf8Printable(filePath), file.error(), qUtf8Printable(file.errorString()));
+        error = file.errorString();
+    }
+
+    if (!success || cancelled) {
+        // Free the partially loaded document right away instead of waiting on the GUI thread
+        loader->Release();
+        loader = Q_NULLPTR;
+        success = false;
+    }
+
+    qInfo("Background load of \"%s\" %s after %lld ms", qUtf8Printable(filePath), success ? "finished" : "stopped", timer.elapsed());
+
+    // This is the last time the worker thread touches this object
+    QMetaObject::invokeMethod(this, [=]() {
+        emit finished(success);
+        deleteLater();
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,76 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FILELOADER_H
+#define FILELOADER_H
+
+#include <QFile>
+#include <QObject>
+#include <QThreadPool>
+
+#include <atomic>
+#include <functional>
+
+#include "FileAnalyzer.h"
+#include "ILoader.h"
+
+
+// Reads a file on a worker thread into a Scintilla document created by SCI_CREATELOADER. The loader
+// owns the document until takeDocument() is called. Once finished() is emitted the object deletes itself.
+class FileLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Receives each chunk of UTF-8 data as it is read. Returning false stops the read.
+    using DataHandler = std::function<bool(const char *data, qint64 length)>;
+
+    explicit FileLoader(const QString &filePath, Scintilla::ILoader *loader);
+    ~FileLoader() override;
+
+    static bool readFile(QFile &file, const DataHandler &handler, FileAnalyzer *analyzer = Q_NULLPTR);
+
+    // The most memory the process has had resident at any one time so far, in bytes. -1 if it isn't known.
+    static qint64 peakMemoryUsage();
+
+    QString getFilePath() const { return filePath; }
+    const FileAnalyzer &getAnalyzer() const { return analyzer; }
+    QString errorString() const { return error; } // Only safe to read once finished() is emitted
+
+    void start(QThreadPool *pool = QThreadPool::globalInstance());
+    void cancel();
+    bool isCancelled() const;
+
+    void *takeDocument();
+
+signals:
+    void progress(qint64 bytesRead, qint64 totalBytes);
+    void finished(bool success);
+
+private:
+    void run();
+
+    const QString filePath;
+    Scintilla::ILoader *loader;
+    std::atomic<bool> cancelled;
+    FileAnalyzer analyzer; // Only safe to read once finished() is emitted
+    QString error;
+};
+
+#endif // FILELOADER_H
@@ -0,0 +1,260 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "FileReloader.h"
+#include "FileLoader.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <algorithm>
+#include <cstring>
+
+
+const qint64 MAX_EDIT_DISTANCE = 1000; // Past this many changed lines just replace everything between the first and last change
+
+const quint64 FNV_OFFSET_BASIS = Q_UINT64_C(14695981039346656037);
+const quint64 FNV_PRIME = Q_UINT64_C(1099511628211);
+
+
+// A run of lines that are the same in both the old and new text
+struct Match {
+    qint64 oldIndex;
+    qint64 newIndex;
+    qint64 length;
+};
+
+// Myers' O(ND) difference algorithm over the lines in [oldBegin, oldEnd) and [newBegin, newEnd). Fills in the
+// matching runs of lines in order. Returns false if it would take more than MAX_EDIT_DISTANCE edits.
+static bool diffLines(const std::vector<quint64> &oldHashes, qint64 oldBegin, qint64 oldEnd,
+                      const std::vector<quint64> &newHashes, qint64 newBegin, qint64 newEnd,
+                      std::vector<Match> &matches)
+{
+    const qint64 n = oldEnd - oldBegin;
+    const qint64 m = newEnd - newBegin;
+    const qint64 maxDistance = qMin(n + m, MAX_EDIT_DISTANCE);
+    const qint64 offset = maxDistance + 1;
+
+    // The furthest x reached on each diagonal k (x - y), along with a copy of it for every step to be able to trace back
+    std::vector<qint64> v(2 * maxDistance + 3, 0);
+    std::vector<std::vector<qint64>> trace;
+
+    for (qint64 d = 0; d <= maxDistance; ++d) {
+        // Only diagonals -d to d can be reached in d steps
+        trace.emplace_back(v.begin() + offset - d, v.begin() + offset + d + 1);
+
+        for (qint64 k = -d; k <= d; k += 2) {
+            qint64 x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) ? v[offset + k + 1] : v[offset + k - 1] + 1;
+            qint64 y = x - k;
+
+            while (x < n && y < m && oldHashes[oldBegin + x] == newHashes[newBegin + y]) {
+                x++;
+                y++;
+            }
+
+            v[offset + k] = x;
+
+            if (x < n || y < m) {
+                continue;
+            }
+
+            // Walk back from the end to find which lines were matched up along the way
+            x = n;
+            y = m;
+
+            for (qint64 step = d; step > 0; --step) {
+                const std::vector<qint64> &previous = trace[step];
+                const qint64 diagonal = x - y;
+                const bool down = diagonal == -step || (diagonal != step && previous[diagonal - 1 + step] < previous[diagonal + 1 + step]);
+                const qint64 previousDiagonal = down ? diagonal + 1 : diagonal - 1;
+                const qint64 previousX = previous[previousDiagonal + step];
+                const qint64 snakeStart = down ? previousX : previousX + 1;
+
+                if (x > snakeStart) {
+                    matches.push_back({oldBegin + snakeStart, newBegin + snakeStart - diagonal, x - snakeStart});
+                }
+
+                x = previousX;
+                y = previousX - previousDiagonal;
+            }
+
+            if (x > 0) {
+                matches.push_back({oldBegin, newBegin, x});
+            }
+
+            std::reverse(matches.begin(), matches.end());
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static QVector<FileReloader::Edit> computeEdits(const FileReloader::Lines &oldLines, const FileReloader::Lines &newLines)
+{
+    const std::vector<quint64> &oldHashes = oldLines.hashes;
+    const std::vector<quint64> &newHashes = newLines.hashes;
+    const qint64 oldCount = static_cast<qint64>(oldHashes.size());
+    const qint64 newCount = static_cast<qint64>(newHashes.size());
+
+    // Changes are usually in one small spot, so get the lines that are the same at the start and end out of the way first
+    qint64 prefix = 0;
+    while (prefix < oldCount && prefix < newCount && oldHashes[prefix] == newHashes[prefix]) {
+        prefix++;
+    }
+
+    qint64 suffix = 0;
+    while (suffix < oldCount - prefix && suffix < newCount - prefix && oldHashes[oldCount - suffix - 1] == newHashes[newCount - suffix - 1]) {
+        suffix++;
+    }
+
+    std::vector<Match> matches;
+
+    if (!diffLines(oldHashes, prefix, oldCount - suffix, newHashes, prefix, newCount - suffix, matches)) {
+        qInfo("Too many lines changed to compare them all, replacing lines %lld to %lld", prefix, oldCount - suffix);
+        matches.clear();
+    }
+
+    // The unchanged lines at the end are the last match, which closes off any edit before it
+    matches.push_back({oldCount - suffix, newCount - suffix, suffix});
+
+    QVector<FileReloader::Edit> edits;
+    qint64 oldIndex = prefix;
+    qint64 newIndex = prefix;
+
+    for (const Match &match : matches) {
+        if (match.oldIndex > oldIndex || match.newIndex > newIndex) {
+            edits.append({oldLines.starts[oldIndex], oldLines.starts[match.oldIndex], newLines.starts[newIndex], newLines.starts[match.newIndex]});
+        }
+
+        oldIndex = match.oldIndex + match.length;
+        newIndex = match.newIndex + match.length;
+    }
+
+    return edits;
+}
+
+FileReloader::Lines FileReloader::hashLines(const QVector<FileWriter::Segment> &segments)
+{
+    Lines lines;
+    quint64 hash = FNV_OFFSET_BASIS;
+    qint64 position = 0;
+    qint64 lineStart = 0;
+
+    // A line can span the end of one segment and the start of the next
+    for (const FileWriter::Segment &segment : segments) {
+        const char *data = segment.data;
+        const char *end = data + segment.length;
+
+        while (data < end) {
+            const char *eol = static_cast<const char *>(memchr(data, '\n', end - data));
+            const char *lineEnd = eol ? eol + 1 : end;
+
+            for (const char *p = data; p < lineEnd; ++p) {
+                hash = (hash ^ static_cast<unsigned char>(*p)) * FNV_PRIME;
+            }
+
+            position += lineEnd - data;
+            data = lineEnd;
+
+            if (eol) {
+                lines.hashes.push_back(hash);
+                lines.starts.push_back(lineStart);
+                hash = FNV_OFFSET_BASIS;
+                lineStart = position;
+            }
+        }
+    }
+
+    // The last line has no line ending
+    if (position > lineStart) {
+        lines.hashes.push_back(hash);
+        lines.starts.push_back(lineStart);
+    }
+
+    lines.starts.push_back(position);
+
+    return lines;
+}
+
+FileReloader::FileReloader(const QString &filePath, Lines &&currentLines) :
+    QObject(Q_NULLPTR),
+    filePath(filePath),
+    currentLines(std::move(currentLines)),
+    cancelled(false)
+{
+}
+
+void FileReloader::start(QThreadPool *pool)
+{
+    pool->start([this]() { run(); });
+}
+
+void FileReloader::cancel()
+{
+    cancelled = true;
+}
+
+bool FileReloader::isCancelled() const
+{
+    return cancelled;
+}
+
+void FileReloader::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(filePath);
+    bool success = false;
+
+    if (file.open(QIODevice::ReadOnly)) {
+        text.reserve(static_cast<int>(file.size()));
+
+        success = FileLoader::readFile(file, [&](const char *data, qint64 length) {
+            if (cancelled) {
+                return false;
+            }
+
+            text.append(data, static_cast<int>(length));
+
+            return true;
+        }, &analyzer);
+
+        file.close();
+    }
+    else {
+        qWarning("QFile::open() failed when opening \"%s\" - error code %d: %s", qUtf8Printable(filePath), file.error(), qUtf8Printable(file.errorString()));
+    }
+
+    if (success && !cancelled) {
+        edits = computeEdits(currentLines, hashLines({{text.constData(), text.size()}}));
+
+        qInfo("Compared \"%s\" to the document in %lld ms, %d change(s) found", qUtf8Printable(filePath), timer.elapsed(), static_cast<int>(edits.size()));
+    }
+
+    // The hashes are not needed any more, no reason to hold on to them until the GUI thread gets around to this
+    currentLines = Lines();
+
+    QMetaObject::invokeMethod(this, [=]() {
+        emit finished(success && !cancelled);
+        deleteLater();
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,87 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FILERELOADER_H
+#define FILERELOADER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+
+#include <atomic>
+#include <vector>
+
+#include "FileAnalyzer.h"
+#include "FileWriter.h"
+
+
+// Reads a file again on a worker thread and works out which lines changed compared to what is in the
+// document, so only those need to be replaced instead of the whole text. Once finished() is emitted
+// the object deletes itself.
+class FileReloader : public QObject
+{
+    Q_OBJECT
+
+public:
+    // A hash of every line (including its line ending), along with where each one starts. The last start
+    // is the total length so the end of any line is where the next one starts.
+    struct Lines {
+        std::vector<quint64> hashes;
+        std::vector<qint64> starts;
+    };
+
+    // Replace the text between oldStart and oldEnd in the document with the text between newStart
+    // and newEnd of the file
+    struct Edit {
+        qint64 oldStart;
+        qint64 oldEnd;
+        qint64 newStart;
+        qint64 newEnd;
+    };
+
+    static Lines hashLines(const QVector<FileWriter::Segment> &segments);
+
+    explicit FileReloader(const QString &filePath, Lines &&currentLines);
+
+    void start(QThreadPool *pool = QThreadPool::globalInstance());
+    void cancel();
+    bool isCancelled() const;
+
+    // These are only safe to use once finished() is emitted. The edits are in order from the start of the
+    // document, and the positions are from before any of them are made.
+    const QVector<Edit> &getEdits() const { return edits; }
+    const QByteArray &getText() const { return text; }
+    const FileAnalyzer &getAnalyzer() const { return analyzer; }
+
+signals:
+    void finished(bool success);
+
+private:
+    void run();
+
+    const QString filePath;
+    Lines currentLines;
+    std::atomic<bool> cancelled;
+
+    QVector<Edit> edits;
+    QByteArray text;
+    FileAnalyzer analyzer;
+};
+
+#endif // FILERELOADER_H
@@ -0,0 +1,194 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "FileWatcher.h"
+#include "EditorManager.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QPointer>
+
+
+const int DEBOUNCE_INTERVAL = 100; // Editors and tools tend to write files in several steps
+
+
+FileWatcher::FileWatcher(EditorManager *editorManager, QObject *parent) :
+    QObject(parent)
+{
+    debounceTimer.setSingleShot(true);
+    debounceTimer.setInterval(DEBOUNCE_INTERVAL);
+
+    // One thread is plenty, the batches are never run in parallel anyway
+    pool.setMaxThreadCount(1);
+
+    connect(&watcher, &QFileSystemWatcher::fileChanged, this, &FileWatcher::fileChanged);
+    connect(&debounceTimer, &QTimer::timeout, this, &FileWatcher::checkPendingFiles);
+    connect(editorManager, &EditorManager::editorCreated, this, &FileWatcher::watchEditor);
+}
+
+FileWatcher::~FileWatcher()
+{
+    // The results of a batch still being checked get posted back to this object
+    pool.waitForDone();
+}
+
+void FileWatcher::checkEditor(ScintillaNext *editor)
+{
+    if (watchedEditors.contains(editor)) {
+        queueCheck(watchedEditors.value(editor));
+    }
+}
+
+void FileWatcher::checkAll()
+{
+    for (const QString &filePath : watchedEditors) {
+        queueCheck(filePath);
+    }
+}
+
+void FileWatcher::fileChanged(const QString &filePath)
+{
+    queueCheck(filePath);
+}
+
+void FileWatcher::watchEditor(ScintillaNext *editor)
+{
+    // Files can come and go from editors, e.g. a new file saved for the first time
+    auto updateEditor = [=]() {
+        unwatchEditor(editor);
+
+        if (editor->isFile()) {
+            QString filePath = editor->getFileInfo().canonicalFilePath();
+
+            // The file may not exist (anymore), it still needs a key so it is noticed once it is back
+            if (filePath.isEmpty()) {
+                filePath = QDir::cleanPath(editor->getFileInfo().absoluteFilePath());
+            }
+
+            watchedEditors.insert(editor, filePath);
+            editorsByPath[filePath].insert(editor);
+            watcher.addPath(filePath);
+        }
+    };
+
+    updateEditor();
+
+    connect(editor, &ScintillaNext::renamed, this, updateEditor);
+    connect(editor, &ScintillaNext::saved, this, updateEditor);
+    connect(editor, &QObject::destroyed, this, [=]() { unwatchEditor(editor); });
+}
+
+void FileWatcher::unwatchEditor(ScintillaNext *editor)
+{
+    if (!watchedEditors.contains(editor)) {
+        return;
+    }
+
+    const QString filePath = watchedEditors.take(editor);
+    auto it = editorsByPath.find(filePath);
+    it->remove(editor);
+
+    // Another editor may still have the same file open
+    if (it->isEmpty()) {
+        editorsByPath.erase(it);
+        watcher.removePath(filePath);
+    }
+}
+
+void FileWatcher::queueCheck(const QString &filePath)
+{
+    pendingFilePaths.insert(filePath);
+
+    // Anything that comes in while a batch is being checked gets picked up once it is done
+    if (!checking && !debounceTimer.isActive()) {
+        debounceTimer.start();
+    }
+}
+
+void FileWatcher::checkPendingFiles()
+{
+    if (pendingFilePaths.isEmpty()) {
+        return;
+    }
+
+    const QStringList filePaths = pendingFilePaths.values();
+    pendingFilePaths.clear();
+    checking = true;
+
+    pool.start([=]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        QVector<FileState> states;
+        states.reserve(filePaths.size());
+
+        for (const QString &filePath : filePaths) {
+            const QFileInfo info(filePath);
+            states.append({filePath, info.exists(), info.lastModified()});
+        }
+
+        qInfo("Checked %d file(s) for changes in %lld ms", static_cast<int>(filePaths.size()), timer.elapsed());
+
+        QMetaObject::invokeMethod(this, [=]() { applyFileStates(states); }, Qt::QueuedConnection);
+    });
+}
+
+void FileWatcher::applyFileStates(const QVector<FileState> &states)
+{
+    checking = false;
+
+    const QStringList files = watcher.files();
+    const QSet<QString> watchedFiles(files.cbegin(), files.cend());
+    QVector<QPair<QPointer<ScintillaNext>, ScintillaNext::FileStateChange>> changes;
+
+    for (const FileState &state : states) {
+        const auto it = editorsByPath.constFind(state.filePath);
+
+        // Nothing has it open any more
+        if (it == editorsByPath.cend()) {
+            continue;
+        }
+
+        // The file system stops watching a file once it is deleted or replaced (e.g. by saving it atomically),
+        // so start watching it again if it is back
+        if (state.exists && !watchedFiles.contains(state.filePath)) {
+            watcher.addPath(state.filePath);
+        }
+
+        for (ScintillaNext *editor : it.value()) {
+            const ScintillaNext::FileStateChange change = editor->updateFileState(state.exists, state.lastModified);
+
+            if (change != ScintillaNext::NoChange) {
+                changes.append(qMakePair(editor, change));
+            }
+        }
+    }
+
+    // Whoever handles these may close editors, which changes the list of watched ones
+    for (const auto &change : changes) {
+        if (change.first) {
+            emit fileStateChanged(change.first, change.second);
+        }
+    }
+
+    if (!pendingFilePaths.isEmpty()) {
+        debounceTimer.start();
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+
+#include "ScintillaNext.h"
+
+
+class EditorManager;
+
+// Keeps track of the files behind every editor and notices when they are changed or deleted by something
+// else. Notifications from the file system are collected for a short while, then the files are all looked
+// at in one go on a worker thread so the GUI never waits on a slow (e.g. network) file system.
+class FileWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileWatcher(EditorManager *editorManager, QObject *parent = Q_NULLPTR);
+    ~FileWatcher() override;
+
+public slots:
+    // Not every file system sends notifications (e.g. NFS), so these can be used to look at the files anyway
+    void checkEditor(ScintillaNext *editor);
+    void checkAll();
+
+signals:
+    void fileStateChanged(ScintillaNext *editor, ScintillaNext::FileStateChange state);
+
+private slots:
+    void fileChanged(const QString &filePath);
+    void checkPendingFiles();
+
+private:
+    struct FileState {
+        QString filePath;
+        bool exists;
+        QDateTime lastModified;
+    };
+
+    void watchEditor(ScintillaNext *editor);
+    void unwatchEditor(ScintillaNext *editor);
+    void queueCheck(const QString &filePath);
+    void applyFileStates(const QVector<FileState> &states);
+
+    QFileSystemWatcher watcher;
+    QTimer debounceTimer;
+    QThreadPool pool;
+
+    QHash<ScintillaNext *, QString> watchedEditors; // The path each editor is being watched under
+    QHash<QString, QSet<ScintillaNext *>> editorsByPath; // The other way around, since several editors can have the same file
+    QSet<QString> pendingFilePaths;
+    bool checking = false;
+};
+
+#endif // FILEWATCHER_H
@@ -0,0 +1,257 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "FileWriter.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMetaEnum>
+#include <QSaveFile>
+#include <QTextCodec>
+
+#include <memory>
+
+#if defined(Q_OS_WIN)
+#include <Windows.h>
+#include <io.h>
+#elif defined(Q_OS_UNIX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+const qint64 WRITE_CHUNK_SIZE = 1024 * 1024 * 4; // Keeps any single write call from being enormous
+
+
+// Returns the number of bytes actually written to the file, or -1 on failure or once cancelled. When converting,
+// the decoder and encoder carry over any partial characters that got split across chunks (or segments).
+static qint64 writeSegment(QFileDevice &file, const FileWriter::Segment &segment, QTextDecoder *decoder, QTextEncoder *encoder, const std::atomic<bool> *cancelled)
+{
+    qint64 offset = 0;
+    qint64 bytesWritten = 0;
+
+    while (offset < segment.length) {
+        if (cancelled && *cancelled) {
+            return -1;
+        }
+
+        const qint64 length = qMin<qint64>(WRITE_CHUNK_SIZE, segment.length - offset);
+
+        if (encoder) {
+            const QByteArray encoded = encoder->fromUnicode(decoder->toUnicode(segment.data + offset, static_cast<int>(length)));
+
+            if (file.write(encoded) != encoded.size()) {
+                return -1;
+            }
+
+            bytesWritten += encoded.size();
+        }
+        else {
+            if (file.write(segment.data + offset, length) != length) {
+                return -1;
+            }
+
+            bytesWritten += length;
+        }
+
+        offset += length;
+    }
+
+    return bytesWritten;
+}
+
+static bool syncFile(QFileDevice &file, bool dataOnly)
+{
+    // Anything still buffered by Qt has to make it to the operating system first
+    if (!file.flush()) {
+        return false;
+    }
+
+#if defined(Q_OS_WIN)
+    Q_UNUSED(dataOnly);
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle())));
+#elif defined(Q_OS_MACOS)
+    Q_UNUSED(dataOnly);
+    // fsync() on macOS only gets the data to the drive, F_FULLFSYNC also flushes the drive's own cache.
+    // Not every file system supports it though.
+    return fcntl(file.handle(), F_FULLFSYNC) == 0 || fsync(file.handle()) == 0;
+#elif defined(Q_OS_UNIX)
+    return (dataOnly ? fdatasync(file.handle()) : fsync(file.handle())) == 0;
+#else
+    Q_UNUSED(dataOnly);
+    return true;
+#endif
+}
+
+// Makes sure the directory entry for the file (e.g. a rename) is on the disk
+static bool syncDirectory(const QString &filePath)
+{
+#if defined(Q_OS_UNIX)
+    const int fd = ::open(QFile::encodeName(QFileInfo(filePath).absolutePath()).constData(), O_RDONLY);
+
+    if (fd == -1) {
+        return false;
+    }
+
+    const bool success = fsync(fd) == 0;
+    ::close(fd);
+
+    return success;
+#else
+    // Windows has no way to flush a directory, NTFS journals the metadata on its own
+    Q_UNUSED(filePath);
+    return true;
+#endif
+}
+
+FileWriter::FileWriter(const QString &filePath) :
+    filePath(filePath)
+{
+}
+
+void FileWriter::setAtomic(bool atomic)
+{
+    this->atomic = atomic;
+}
+
+void FileWriter::setSyncMode(SyncMode mode)
+{
+    syncMode = mode;
+}
+
+void FileWriter::setEncoding(QTextCodec *codec, bool writeBom)
+{
+    // The text is already UTF-8 so there is no need to go through a codec for it
+    this->codec = (codec && codec->mibEnum() == 106) ? Q_NULLPTR : codec;
+    this->writeBom = writeBom;
+}
+
+void FileWriter::setCancelFlag(const std::atomic<bool> *cancelled)
+{
+    this->cancelled = cancelled;
+}
+
+QFileDevice::FileError FileWriter::write(const QVector<Segment> &segments)
+{
+    qInfo(Q_FUNC_INFO);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(filePath);
+    QSaveFile saveFile(filePath);
+    QFileDevice &device = atomic ? static_cast<QFileDevice &>(saveFile) : static_cast<QFileDevice &>(file);
+
+    // NOTE: no direct write fallback. If a temporary file can't be created next to the original (e.g. the
+    // directory is not writable) the save fails and leaves the original alone, saving in place is up to the caller.
+
+    if (!device.open(QIODevice::WriteOnly)) {
+        qWarning("FileWriter::write() failed to open \"%s\" - error code %d: %s", qUtf8Printable(filePath), device.error(), qUtf8Printable(device.errorString()));
+        return device.error();
+    }
+
+    qint64 totalBytes = 0;
+    bool success = true;
+    std::unique_ptr<QTextDecoder> decoder;
+    std::unique_ptr<QTextEncoder> encoder;
+
+    if (codec) {
+        // The codec writes its own BOM unless told not to
+        decoder.reset(QTextCodec::codecForMib(106)->makeDecoder());
+        encoder.reset(codec->makeEncoder(writeBom ? QTextCodec::DefaultConversion : QTextCodec::IgnoreHeader));
+    }
+    else if (writeBom) {
+        totalBytes = device.write("\xEF\xBB\xBF", 3);
+        success = totalBytes == 3;
+    }
+
+    for (int i = 0; success && i < segments.size(); ++i) {
+        const qint64 bytesWritten = writeSegment(device, segments[i], decoder.get(), encoder.get(), cancelled);
+
+        success = bytesWritten != -1;
+        totalBytes += bytesWritten;
+    }
+
+    if (!success && cancelled && *cancelled) {
+        qInfo("FileWriter::write() cancelled writing \"%s\"", qUtf8Printable(filePath));
+
+        if (atomic) {
+            saveFile.cancelWriting();
+        }
+
+        return QFileDevice::AbortError;
+    }
+
+    if (!success) {
+        qWarning("FileWriter::write() failed to write \"%s\" - error code %d: %s", qUtf8Printable(filePath), device.error(), qUtf8Printable(device.errorString()));
+
+        if (atomic) {
+            // Leaves the original file untouched
+            saveFile.cancelWriting();
+        }
+
+        return device.error() != QFileDevice::NoError ? device.error() : QFileDevice::WriteError;
+    }
+
+    if (encoder && encoder->hasFailure()) {
+        qWarning("Some characters could not be represented in %s when writing \"%s\"", codec->name().constData(), qUtf8Printable(filePath));
+    }
+
+    const qint64 writeTime = timer.elapsed();
+    bool synced = true;
+
+    if (atomic) {
+        // NOTE: QSaveFile::commit() always syncs the temporary file before renaming it into place, so
+        // the only thing left for the sync mode to do is make sure the rename itself is durable.
+        if (!saveFile.commit()) {
+            qWarning("QSaveFile::commit() failed for \"%s\" - error code %d: %s", qUtf8Printable(filePath), saveFile.error(), qUtf8Printable(saveFile.errorString()));
+            return saveFile.error() != QFileDevice::NoError ? saveFile.error() : QFileDevice::WriteError;
+        }
+
+        if (syncMode == FullSync) {
+            synced = syncDirectory(filePath);
+        }
+    }
+    else {
+        if (syncMode != NoSync) {
+            synced = syncFile(file, syncMode == DataSync);
+
+            if (synced && syncMode == FullSync) {
+                synced = syncDirectory(filePath);
+            }
+        }
+
+        file.close();
+    }
+
+    if (!synced) {
+        // The data was still handed to the operating system, so this is not treated as a failure
+        qWarning("Unable to sync \"%s\" to disk", qUtf8Printable(filePath));
+    }
+
+    const qint64 elapsed = timer.elapsed();
+    qInfo("Wrote %lld bytes (%s%s) in %d segment(s) to \"%s\" in %lld ms (%.1f MB/s), %s with %s took %lld ms to finish",
+          totalBytes, codec ? codec->name().constData() : "UTF-8", writeBom ? " with BOM" : "",
+          static_cast<int>(segments.size()), qUtf8Printable(filePath), elapsed,
+          elapsed > 0 ? totalBytes / (1024.0 * 1024.0) / (elapsed / 1000.0) : 0.0,
+          atomic ? "atomic" : "in place", QMetaEnum::fromType<SyncMode>().valueToKey(syncMode), elapsed - writeTime);
+
+    return QFileDevice::NoError;
+}
@@ -0,0 +1,77 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FILEWRITER_H
+#define FILEWRITER_H
+
+#include <QFileDevice>
+#include <QObject>
+#include <QVector>
+
+#include <atomic>
+
+
+class QTextCodec;
+
+// Writes a list of memory segments of UTF-8 text out to a file, optionally converting it to another
+// encoding. It is written either in place or atomically by writing to a temporary file which then
+// replaces the original.
+class FileWriter
+{
+    Q_GADGET
+
+public:
+    // How hard to try to make sure the data actually reached the disk before reporting success
+    enum SyncMode {
+        NoSync, // Leave it up to the operating system
+        DataSync, // Flush the file's data, e.g. fdatasync()
+        FullSync, // Flush the file's data and metadata, along with the directory entry
+    };
+    Q_ENUM(SyncMode)
+
+    // A contiguous piece of memory to write
+    struct Segment {
+        const char *data;
+        qint64 length;
+    };
+
+    explicit FileWriter(const QString &filePath);
+
+    void setAtomic(bool atomic);
+    void setSyncMode(SyncMode mode);
+
+    // A null codec writes the UTF-8 text as is
+    void setEncoding(QTextCodec *codec, bool writeBom);
+
+    // Checked between chunks, once it is set the write stops and returns QFileDevice::AbortError. An atomic
+    // write leaves the original alone, an in place one leaves whatever had been written so far.
+    void setCancelFlag(const std::atomic<bool> *cancelled);
+
+    QFileDevice::FileError write(const QVector<Segment> &segments);
+
+private:
+    const QString filePath;
+    bool atomic = false;
+    SyncMode syncMode = NoSync;
+    QTextCodec *codec = Q_NULLPTR;
+    bool writeBom = false;
+    const std::atomic<bool> *cancelled = Q_NULLPTR;
+};
+
+#endif // FILEWRITER_H
@@ -0,0 +1,249 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "FindInFilesSearcher.h"
+#include "FileAnalyzer.h"
+#include "ISearchResultsHandler.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QTextCodec>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+
+const int DETECTION_SIZE = 1024 * 64; // Same as the loader, so files are decoded the same way it would
+
+
+static QRegularExpression wildcardExpression(const QString &pattern)
+{
+#ifdef Q_OS_WIN
+    const QRegularExpression::PatternOptions options = QRegularExpression::CaseInsensitiveOption;
+#else
+    const QRegularExpression::PatternOptions options = QRegularExpression::NoPatternOption;
+#endif
+
+    return QRegularExpression(QRegularExpression::wildcardToRegularExpression(pattern), options);
+}
+
+static bool matchesAny(const QVector<QRegularExpression> &expressions, const QString &name)
+{
+    return std::any_of(expressions.cbegin(), expressions.cend(), [&](const QRegularExpression &re) { return re.match(name).hasMatch(); });
+}
+
+// Sets tooBig instead of searching if the file is more than can be converted in one go (or matched as a QString)
+static QVector<LineMatches> searchOpenFile(QFile &file, const TextSearcher &searcher, const std::atomic<bool> &cancelled, bool &tooBig)
+{
+    QByteArray buffer;
+    qint64 length = file.size();
+    uchar *mapped = file.map(0, length);
+    const char *data = reinterpret_cast<const char *>(mapped);
+
+    if (mapped == Q_NULLPTR) {
+        qDebug("QFile::map() failed, falling back to reading: %s", qUtf8Printable(file.errorString()));
+
+        buffer = file.readAll();
+        data = buffer.constData();
+        length = buffer.size();
+    }
+
+    const QByteArray head = QByteArray::fromRawData(data, static_cast<int>(qMin<qint64>(length, DETECTION_SIZE)));
+    QByteArray charset;
+    bool hasBom = false;
+    QTextCodec *codec = FileAnalyzer::detectCodec(head, charset, hasBom);
+
+    QVector<LineMatches> lines;
+
+    if (!hasBom && memchr(head.constData(), '\0', head.size()) != Q_NULLPTR) {
+        // Text practically never has NUL bytes in it, unless it is UTF-16 or UTF-32 which would have had a BOM
+        qDebug("Skipping binary file \"%s\"", qUtf8Printable(file.fileName()));
+    }
+    else if (FileAnalyzer::isUtf8Compatible(charset) || codec == Q_NULLPTR) {
+        // The editor holds these bytes as they are, other than a UTF-8 BOM
+        const qint64 bomLength = hasBom ? 3 : 0;
+
+        if (searcher.canSearch(length - bomLength)) {
+            lines = searcher.findAll(data + bomLength, length - bomLength, cancelled);
+        }
+        else {
+            tooBig = true;
+        }
+    }
+    else if (length > INT_MAX) {
+        tooBig = true;
+    }
+    else {
+        // Search what the loader would turn it into, so that the positions line up once it is opened
+        const QByteArray utf8 = codec->toUnicode(data, static_cast<int>(length)).toUtf8();
+
+        lines = searcher.findAll(utf8.constData(), utf8.size(), cancelled);
+    }
+
+    if (mapped) {
+        file.unmap(mapped);
+    }
+
+    return lines;
+}
+
+
+bool FindInFilesSearcher::WalkOptions::isIncluded(const QString &fileName) const
+{
+    return (includes.isEmpty() || matchesAny(includes, fileName)) && !matchesAny(excludes, fileName);
+}
+
+bool FindInFilesSearcher::WalkOptions::isExcludedFolder(const QString &folderName) const
+{
+    return matchesAny(excludedFolders, folderName);
+}
+
+
+FindInFilesSearcher::FindInFilesSearcher(QObject *parent) :
+    BackgroundSearcher(parent)
+{
+}
+
+FindInFilesSearcher::~FindInFilesSearcher()
+{
+    waitForTasks();
+}
+
+void FindInFilesSearcher::setFilters(const QString &filters)
+{
+    options.includes.clear();
+    options.excludes.clear();
+    options.excludedFolders.clear();
+
+    for (const QString &filter : filters.split(QRegularExpression(QStringLiteral("[\\s;]+")), Qt::SkipEmptyParts)) {
+        if (filter.startsWith('!')) {
+            const QString pattern = filter.mid(1);
+
+            if (pattern.startsWith('\\') || pattern.startsWith('/')) {
+                options.excludedFolders.append(wildcardExpression(pattern.mid(1)));
+            }
+            else if (!pattern.isEmpty()) {
+                options.excludes.append(wildcardExpression(pattern));
+            }
+        }
+        else {
+            options.includes.append(wildcardExpression(filter));
+        }
+    }
+}
+
+bool FindInFilesSearcher::start(const QString &directory, const QString &text, int searchFlags, ISearchResultsHandler *handler)
+{
+    qInfo(Q_FUNC_INFO);
+
+    if (!begin(text, searchFlags, handler)) {
+        return false;
+    }
+
+    const WalkOptions walkOptions = options;
+    pool.start([=]() { walk(directory, walkOptions); });
+
+    return true;
+}
+
+void FindInFilesSearcher::walk(const QString &directory, const WalkOptions &walkOptions)
+{
+    QDir::Filters filters = QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot;
+    QStringList folders = {directory};
+    int filesFound = 0;
+
+    if (walkOptions.hidden) {
+        filters |= QDir::Hidden;
+    }
+
+    while (!folders.isEmpty() && !cancelled) {
+        QDirIterator it(folders.takeLast(), filters);
+
+        while (it.hasNext() && !cancelled) {
+            it.next();
+
+            const QFileInfo info = it.fileInfo();
+
+            if (info.isDir()) {
+                // Following links to folders could end up going around in circles
+                if (walkOptions.subfolders && !info.isSymLink() && !walkOptions.isExcludedFolder(info.fileName())) {
+                    folders.append(info.filePath());
+                }
+            }
+            else if (walkOptions.isIncluded(info.fileName())) {
+                const QString filePath = info.filePath();
+
+                // Whichever thread is free next picks it up, while this one keeps looking for more
+                filesFound++;
+                queueTask([=]() { searchFile(filePath); });
+            }
+        }
+    }
+
+    qInfo("Found %d files to search in \"%s\"", filesFound, qUtf8Printable(directory));
+
+    finishQueueing();
+}
+
+void FindInFilesSearcher::searchFile(const QString &filePath)
+{
+    QFile file(filePath);
+
+    if (file.open(QIODevice::ReadOnly)) {
+        bool tooBig = false;
+        FileMatches matches{filePath, file.size() > 0 ? searchOpenFile(file, *searcher, cancelled, tooBig) : QVector<LineMatches>()};
+
+        if (tooBig) {
+            qWarning("Skipping \"%s\", it is too big to search this way (%lld bytes)", qUtf8Printable(filePath), file.size());
+            skipped++;
+            return;
+        }
+
+        searched++;
+
+        if (!matches.lines.isEmpty()) {
+            QMutexLocker locker(&pendingMutex);
+            pending.append(matches);
+        }
+    }
+    else {
+        qWarning("Unable to open \"%s\": %s", qUtf8Printable(filePath), qUtf8Printable(file.errorString()));
+    }
+}
+
+void FindInFilesSearcher::flushResults()
+{
+    QVector<FileMatches> batch;
+
+    {
+        QMutexLocker locker(&pendingMutex);
+        batch.swap(pending);
+    }
+
+    // Files show up in whatever order they got searched in
+    for (const FileMatches &matches : batch) {
+        handler->newFileEntry(matches.filePath);
+        reportMatches(matches.lines);
+    }
+
+    matched += batch.size();
+}
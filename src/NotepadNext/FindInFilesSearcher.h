@@ -0,0 +1,81 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FINDINFILESSEARCHER_H
+#define FINDINFILESSEARCHER_H
+
+#include "BackgroundSearcher.h"
+
+#include <QMutex>
+#include <QRegularExpression>
+#include <QVector>
+
+
+// Searches every file under a directory without opening any of them in an editor. One thread walks the
+// directory tree while the rest of the pool searches each file it finds, memory mapped where possible.
+class FindInFilesSearcher : public BackgroundSearcher
+{
+    Q_OBJECT
+
+public:
+    explicit FindInFilesSearcher(QObject *parent = nullptr);
+    ~FindInFilesSearcher() override;
+
+    // Wildcards separated by spaces or semicolons, e.g. "*.cpp *.h". Ones starting with ! leave out
+    // matching files instead, and "!\name" leaves out every folder with that name. Empty means all files.
+    void setFilters(const QString &filters);
+    void setSearchSubfolders(bool subfolders) { options.subfolders = subfolders; }
+    void setSearchHiddenFolders(bool hidden) { options.hidden = hidden; }
+
+    // Any search still going is stopped first. Returns false if the text can't be searched for.
+    bool start(const QString &directory, const QString &text, int searchFlags, ISearchResultsHandler *handler);
+
+protected:
+    void flushResults() override;
+
+private:
+    // The walk gets its own copy of these, so they can be changed while it is going
+    struct WalkOptions
+    {
+        QVector<QRegularExpression> includes;
+        QVector<QRegularExpression> excludes;
+        QVector<QRegularExpression> excludedFolders;
+        bool subfolders = true;
+        bool hidden = false;
+
+        bool isIncluded(const QString &fileName) const;
+        bool isExcludedFolder(const QString &folderName) const;
+    };
+
+    struct FileMatches
+    {
+        QString filePath;
+        QVector<LineMatches> lines;
+    };
+
+    void walk(const QString &directory, const WalkOptions &walkOptions);
+    void searchFile(const QString &filePath);
+
+    WalkOptions options;
+
+    QMutex pendingMutex;
+    QVector<FileMatches> pending;
+};
+
+#endif // FINDINFILESSEARCHER_H
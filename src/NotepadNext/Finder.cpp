@@ -46,42 +46,42 @@ void Finder::setSearchText(const QString &text)
     this->text = text;
 }
 
-Sci_CharacterRange Finder::findNext(int startPos)
+Sci_CharacterRangeFull Finder::findNext(Sci_Position startPos)
 {
     did_latest_search_wrap = false;
 
     if (text.isEmpty())
         return {INVALID_POSITION, INVALID_POSITION};
 
-    const int pos = startPos == INVALID_POSITION ? editor->selectionEnd() : startPos;
+    const Sci_Position pos = startPos == INVALID_POSITION ? editor->selectionEnd() : startPos;
     const QByteArray textData = text.toUtf8();
 
     editor->setTargetRange(pos, editor->length());
     editor->setSearchFlags(search_flags);
 
     if (editor->searchInTarget(textData.length(), textData.constData()) != INVALID_POSITION) {
-        return {static_cast<Sci_PositionCR>(editor->targetStart()), static_cast<Sci_PositionCR>(editor->targetEnd())};
+        return {editor->targetStart(), editor->targetEnd()};
     }
     else if (wrap) {
         editor->setTargetRange(0, pos);
         if (editor->searchInTarget(textData.length(), textData.constData()) != INVALID_POSITION) {
             did_latest_search_wrap = true;
 
-            return {static_cast<Sci_PositionCR>(editor->targetStart()), static_cast<Sci_PositionCR>(editor->targetEnd())};
+            return {editor->targetStart(), editor->targetEnd()};
         }
     }
 
     return {INVALID_POSITION, INVALID_POSITION};
 }
 
-Sci_CharacterRange Finder::findPrev()
+Sci_CharacterRangeFull Finder::findPrev()
 {
     did_latest_search_wrap = false;
 
     if (text.isEmpty())
         return {INVALID_POSITION, INVALID_POSITION};
 
-    const int pos = editor->selectionStart();
+    const Sci_Position pos = editor->selectionStart();
     const QByteArray textData = text.toUtf8();
 
     editor->setTargetRange(pos, editor->length());
@@ -90,14 +90,14 @@ Sci_CharacterRange Finder::findPrev()
     auto range = editor->findText(editor->searchFlags(), textData.constData(), pos, 0);
 
     if (range.first != INVALID_POSITION) {
-        return {static_cast<Sci_PositionCR>(range.first), static_cast<Sci_PositionCR>(range.second)};
+        return {range.first, range.second};
     }
     else if (wrap) {
         range = editor->findText(editor->searchFlags(), textData.constData(), editor->length(), pos);
         if (range.first != INVALID_POSITION) {
             did_latest_search_wrap = true;
 
-            return {static_cast<Sci_PositionCR>(range.first), static_cast<Sci_PositionCR>(range.second)};
+            return {range.first, range.second};
         }
     }
 
@@ -110,7 +110,7 @@ int Finder::count()
     int total = 0;
 
     if (text.length() > 0) {
-        forEachMatch([&](int start, int end) {
+        forEachMatch([&](Sci_Position start, Sci_Position end) {
             Q_UNUSED(start);
             total++;
             return end;
@@ -120,7 +120,7 @@ int Finder::count()
     return total;
 }
 
-Sci_CharacterRange Finder::replaceSelectionIfMatch(const QString &replaceText)
+Sci_CharacterRangeFull Finder::replaceSelectionIfMatch(const QString &replaceText)
 {
     const QByteArray textData = text.toUtf8();
     bool isRegex = editor->searchFlags() & SCFIND_REGEXP;
@@ -138,7 +138,7 @@ Sci_CharacterRange Finder::replaceSelectionIfMatch(const QString &replaceText)
         else
             editor->replaceTarget(replaceData.length(), replaceData.constData());
 
-        return {static_cast<Sci_PositionCR>(editor->targetStart()), static_cast<Sci_PositionCR>(editor->targetEnd())};
+        return {editor->targetStart(), editor->targetEnd()};
     }
 
     return {INVALID_POSITION, INVALID_POSITION};
@@ -152,7 +152,7 @@ int Finder::replaceAll(const QString &replaceText)
     const QByteArray &replaceData = replaceText.toUtf8();
     const QByteArray &b = text.toUtf8();
     const char *c = b.constData();
-    Sci_TextToFind ttf {{0, (Sci_PositionCR)editor->length()}, c, {-1, -1}};
+    Sci_TextToFindFull ttf {{0, editor->length()}, c, {-1, -1}};
     const bool isRegex = search_flags & SCFIND_REGEXP;
     int total = 0;
 
@@ -162,9 +162,9 @@ int Finder::replaceAll(const QString &replaceText)
     // NOTE: can't use editor->forEachMatch() here since the search range can grow since the document is changing
 
     const UndoAction ua(editor);
-    while (editor->send(SCI_FINDTEXT, search_flags, reinterpret_cast<sptr_t>(&ttf)) != -1) {
-        const int start = ttf.chrgText.cpMin;
-        const int end = ttf.chrgText.cpMax;
+    while (editor->send(SCI_FINDTEXTFULL, search_flags, reinterpret_cast<sptr_t>(&ttf)) != -1) {
+        const Sci_Position start = ttf.chrgText.cpMin;
+        const Sci_Position end = ttf.chrgText.cpMax;
 
         editor->setTargetRange(start, end);
 
@@ -32,20 +32,20 @@ public:
     void setWrap(bool wrap);
     void setSearchText(const QString &text);
 
-    Sci_CharacterRange findNext(int startPos = INVALID_POSITION);
-    Sci_CharacterRange findPrev();
+    Sci_CharacterRangeFull findNext(Sci_Position startPos = INVALID_POSITION);
+    Sci_CharacterRangeFull findPrev();
     int count();
 
     bool didLatestSearchWrapAround() const { return did_latest_search_wrap; }
 
-    Sci_CharacterRange replaceSelectionIfMatch(const QString &replaceText);
+    Sci_CharacterRangeFull replaceSelectionIfMatch(const QString &replaceText);
     int replaceAll(const QString &replaceText);
 
     template<typename Func>
-    void forEachMatch(Func callback) { forEachMatchInRange(callback, {0, (Sci_PositionCR)editor->length()}); }
+    void forEachMatch(Func callback) { forEachMatchInRange(callback, {0, editor->length()}); }
 
     template<typename Func>
-    void forEachMatchInRange(Func callback, Sci_CharacterRange range);
+    void forEachMatchInRange(Func callback, Sci_CharacterRangeFull range);
 
 private:
     ScintillaNext *editor;
@@ -58,7 +58,7 @@ private:
 
 
 template<typename Func>
-void Finder::forEachMatchInRange(Func callback, Sci_CharacterRange range)
+void Finder::forEachMatchInRange(Func callback, Sci_CharacterRangeFull range)
 {
     editor->setSearchFlags(search_flags);
     editor->forEachMatchInRange(text.toUtf8(), callback, range);
@@ -17,6 +17,7 @@
  */
 
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -617,6 +618,33 @@ static int cf_pane_metatable_newindex(lua_State *L) {
     return 0;
 }
 
+static int cf_pane_textrange(lua_State *L) {
+    check_pane_object(L, 1);
+
+    if (lua_gettop(L) >= 3) {
+        const lua_Integer cpMin = luaL_checkinteger(L, 2);
+        const lua_Integer cpMax = luaL_checkinteger(L, 3);
+        const lua_Integer docLength = static_cast<lua_Integer>(editor->length());
+
+        if (cpMin < 0 || cpMin > docLength) {
+            raise_ferror(L, "Invalid argument 1 for <pane>:textrange.  Position between 0 and %I expected.", docLength);
+        }
+        else if (cpMax < cpMin || cpMax > docLength) {
+            raise_ferror(L, "Invalid argument 2 for <pane>:textrange.  Position between %I and %I expected.", cpMin, docLength);
+        }
+        else if (cpMax - cpMin >= INT_MAX) {
+            raise_error(L, "Range too large for <pane>:textrange.  Less than 2 GB of text expected.");
+        }
+
+        const QByteArray range = editor->get_text_range(static_cast<sptr_t>(cpMin), static_cast<sptr_t>(cpMax));
+        lua_pushlstring(L, range.constData(), range.size());
+        return 1;
+    }
+
+    raise_error(L, "Not enough arguments for <pane>:textrange");
+    return 0;
+}
+
 void push_pane_object(lua_State *L, NppExtensionAPIPane p) {
     *static_cast<NppExtensionAPIPane *>(lua_newuserdata(L, sizeof(p))) = p;
     if (luaL_newmetatable(L, "Nn_MT_Pane")) {
@@ -629,6 +657,9 @@ void push_pane_object(lua_State *L, NppExtensionAPIPane p) {
 
         // Push built-in functions into the metatable, where the custom
         // __index metamethod will find them.
+
+        lua_pushcfunction(L, cf_pane_textrange);
+        lua_setfield(L, -2, "textrange");
     }
     lua_setmetatable(L, -2);
 }
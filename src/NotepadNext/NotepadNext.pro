@@ -31,6 +31,7 @@ include(../scintilla.pri)
 include(../lexilla.pri)
 include(../uchardet.pri)
 include(../lua.pri)
+include(../pcre2.pri)
 include(../ads.pri)
 include(../editorconfig-core-qt/EditorConfig.pri)
 win32:include(../QSimpleUpdater/QSimpleUpdater.pri)
@@ -62,15 +63,25 @@ license.files = ../../LICENSE
 license.path = $$OUT_PWD
 
 SOURCES += \
+    BackgroundSearcher.cpp \
     ColorPickerDelegate.cpp \
     ComboBoxDelegate.cpp \
     Converter.cpp \
     DebugManager.cpp \
     DockedEditor.cpp \
+    EditJournal.cpp \
     EditorHexViewerTableModel.cpp \
     EditorManager.cpp \
     EditorPrintPreviewRenderer.cpp \
+    EditorViewState.cpp \
+    FileAnalyzer.cpp \
     FileDialogHelpers.cpp \
+    FileFollower.cpp \
+    FileLoader.cpp \
+    FileReloader.cpp \
+    FileWatcher.cpp \
+    FileWriter.cpp \
+    FindInFilesSearcher.cpp \
     Finder.cpp \
     HtmlConverter.cpp \
     IFaceTable.cpp \
@@ -86,6 +97,9 @@ SOURCES += \
     MacroStepTableModel.cpp \
     NotepadNextApplication.cpp \
     NppImporter.cpp \
+    OpenDocumentsSearcher.cpp \
+    PagedFileViewer.cpp \
+    Pcre2RegexSearch.cpp \
     QRegexSearch.cpp \
     QuickFindWidget.cpp \
     RangeAllocator.cpp \
@@ -98,9 +112,13 @@ SOURCES += \
     SearchResultsCollector.cpp \
     SelectionTracker.cpp \
     SessionManager.cpp \
+    SessionManifest.cpp \
     Settings.cpp \
     SpinBoxDelegate.cpp \
+    TabHibernator.cpp \
+    TextSearcher.cpp \
     UndoAction.cpp \
+    Utf8Validator.cpp \
     ZoomEventWatcher.cpp \
     decorators/ApplicationDecorator.cpp \
     decorators/AutoCompletion.cpp \
@@ -135,16 +153,26 @@ SOURCES += \
     widgets/StatusLabel.cpp
 
 HEADERS += \
+    BackgroundSearcher.h \
     ColorPickerDelegate.h \
     ComboBoxDelegate.h \
     Converter.h \
     DebugManager.h \
     DockedEditor.h \
     DockedEditorTitleBar.h \
+    EditJournal.h \
     EditorHexViewerTableModel.h \
     EditorManager.h \
     EditorPrintPreviewRenderer.h \
+    EditorViewState.h \
+    FileAnalyzer.h \
     FileDialogHelpers.h \
+    FileFollower.h \
+    FileLoader.h \
+    FileReloader.h \
+    FileWatcher.h \
+    FileWriter.h \
+    FindInFilesSearcher.h \
     Finder.h \
     FocusWatcher.h \
     HtmlConverter.h \
@@ -162,6 +190,9 @@ HEADERS += \
     MacroStepTableModel.h \
     NotepadNextApplication.h \
     NppImporter.h \
+    OpenDocumentsSearcher.h \
+    PagedFileViewer.h \
+    Pcre2RegexSearch.h \
     QRegexSearch.h \
     QuickFindWidget.h \
     RangeAllocator.h \
@@ -175,9 +206,13 @@ HEADERS += \
     SearchResultsCollector.h \
     SelectionTracker.h \
     SessionManager.h \
+    SessionManifest.h \
     Settings.h \
     SpinBoxDelegate.h \
+    TabHibernator.h \
+    TextSearcher.h \
     UndoAction.h \
+    Utf8Validator.h \
     ZoomEventWatcher.h \
     decorators/ApplicationDecorator.h \
     decorators/AutoCompletion.h \
@@ -244,8 +279,8 @@ DEFINES += LUA_VERSION_NUM=503
 
 INCLUDEPATH += $$PWD/../lexilla/include
 
-win32-g++:LIBS += libUser32
-win32-msvc*:LIBS += User32.lib
+win32-g++:LIBS += libUser32 libPsapi
+win32-msvc*:LIBS += User32.lib Psapi.lib
 
 OBJECTS_DIR = build/obj
 MOC_DIR = build/moc
@@ -21,9 +21,11 @@
 #include "NotepadNextApplication.h"
 #include "RecentFilesListManager.h"
 #include "EditorManager.h"
+#include "FileWatcher.h"
 #include "LuaExtension.h"
 #include "DebugManager.h"
 #include "SessionManager.h"
+#include "TabHibernator.h"
 
 #include "LuaState.h"
 #include "lua.hpp"
@@ -35,7 +37,10 @@
 #include "Lexilla.h"
 
 #include <QCommandLineParser>
+#include <QMetaEnum>
 #include <QSettings>
+#include <QThread>
+#include <QTimer>
 
 #ifdef Q_OS_WIN
 #include <Windows.h>
@@ -108,8 +113,10 @@ bool NotepadNextApplication::init()
 
     recentFilesListManager = new RecentFilesListManager(this);
     editorManager = new EditorManager(this);
+    fileWatcher = new FileWatcher(editorManager, this);
     settings = new Settings(this);
     sessionManager = new SessionManager(this);
+    tabHibernator = new TabHibernator(editorManager, this);
 
     connect(editorManager, &EditorManager::editorCreated, recentFilesListManager, [=](ScintillaNext *editor) {
         if (editor->isFile()) {
@@ -123,8 +130,23 @@ bool NotepadNextApplication::init()
         }
     });
 
+    // Saving is done by the editors themselves so keep them in sync with the settings
+    connect(editorManager, &EditorManager::editorCreated, settings, [=](ScintillaNext *editor) {
+        editor->setAtomicSave(settings->atomicSave());
+        editor->setSaveSyncMode(settings->saveSyncMode());
+
+        connect(settings, &Settings::atomicSaveChanged, editor, &ScintillaNext::setAtomicSave);
+        connect(settings, &Settings::saveSyncModeChanged, editor, &ScintillaNext::setSaveSyncMode);
+    });
+
     loadSettings();
 
+    editorManager->setMaxConcurrentLoads(settings->maxConcurrentLoads());
+    connect(settings, &Settings::maxConcurrentLoadsChanged, editorManager, &EditorManager::setMaxConcurrentLoads);
+
+    tabHibernator->setIdleTimeout(settings->hibernateAfter());
+    connect(settings, &Settings::hibernateAfterChanged, tabHibernator, &TabHibernator::setIdleTimeout);
+
     connect(this, &NotepadNextApplication::aboutToQuit, this, &NotepadNextApplication::saveSettings);
 
     EditorConfigAppDecorator *ecad = new EditorConfigAppDecorator(this);
@@ -216,6 +238,25 @@ bool NotepadNextApplication::init()
 
     openFiles(parser.positionalArguments());
 
+    // Only what changed since the last snapshot gets written out, so this is cheap enough to do regularly
+    QTimer *sessionSnapshotTimer = new QTimer(this);
+    connect(sessionSnapshotTimer, &QTimer::timeout, this, [=]() {
+        if (settings->restorePreviousSession()) {
+            getSessionManager()->saveSession(window);
+        }
+    });
+
+    auto setSnapshotInterval = [=](int seconds) {
+        if (seconds > 0) {
+            sessionSnapshotTimer->start(seconds * 1000);
+        }
+        else {
+            sessionSnapshotTimer->stop();
+        }
+    };
+    setSnapshotInterval(settings->sessionSnapshotInterval());
+    connect(settings, &Settings::sessionSnapshotIntervalChanged, this, setSnapshotInterval);
+
     // If the window does not have any editors (meaning the no files were
     // specified on the command line) then create a new empty file
     if (window->editorCount() == 0) {
@@ -458,7 +499,20 @@ void NotepadNextApplication::loadSettings()
     settings->setRestorePreviousSession(qsettings.value("App/RestorePreviousSession", false).toBool());
     settings->setRestoreUnsavedFiles(qsettings.value("App/RestoreUnsavedFiles", false).toBool());
     settings->setRestoreTempFiles(qsettings.value("App/RestoreTempFiles", false).toBool());
+    settings->setRestoreFilesOnDemand(qsettings.value("App/RestoreFilesOnDemand", true).toBool());
+    settings->setSessionSnapshotInterval(qsettings.value("App/SessionSnapshotInterval", 60).toInt());
     recentFilesListManager->setFileList(qsettings.value("App/RecentFilesList").toStringList());
+
+    const QMetaEnum syncModes = QMetaEnum::fromType<FileWriter::SyncMode>();
+    bool isValidSyncMode = false;
+    const int syncMode = syncModes.keyToValue(qsettings.value("App/SaveSyncMode").toByteArray().constData(), &isValidSyncMode);
+
+    settings->setAtomicSave(qsettings.value("App/AtomicSave", false).toBool());
+    settings->setSaveSyncMode(isValidSyncMode ? static_cast<FileWriter::SyncMode>(syncMode) : FileWriter::NoSync);
+    settings->setBackgroundSave(qsettings.value("App/BackgroundSave", false).toBool());
+
+    settings->setMaxConcurrentLoads(qsettings.value("App/MaxConcurrentLoads", QThread::idealThreadCount()).toInt());
+    settings->setHibernateAfter(qsettings.value("App/HibernateAfter", 60).toInt());
 }
 
 void NotepadNextApplication::saveSettings()
@@ -468,7 +522,15 @@ void NotepadNextApplication::saveSettings()
     qsettings.setValue("App/RestorePreviousSession", settings->restorePreviousSession());
     qsettings.setValue("App/RestoreUnsavedFiles", settings->restoreUnsavedFiles());
     qsettings.setValue("App/RestoreTempFiles", settings->restoreTempFiles());
+    qsettings.setValue("App/RestoreFilesOnDemand", settings->restoreFilesOnDemand());
+    qsettings.setValue("App/SessionSnapshotInterval", settings->sessionSnapshotInterval());
     qsettings.setValue("App/RecentFilesList", recentFilesListManager->fileList());
+
+    qsettings.setValue("App/AtomicSave", settings->atomicSave());
+    qsettings.setValue("App/SaveSyncMode", QMetaEnum::fromType<FileWriter::SyncMode>().valueToKey(settings->saveSyncMode()));
+    qsettings.setValue("App/BackgroundSave", settings->backgroundSave());
+    qsettings.setValue("App/MaxConcurrentLoads", settings->maxConcurrentLoads());
+    qsettings.setValue("App/HibernateAfter", settings->hibernateAfter());
 }
 
 MainWindow *NotepadNextApplication::createNewWindow()
@@ -482,6 +544,8 @@ MainWindow *NotepadNextApplication::createNewWindow()
         LuaExtension::Instance().setEditor(editor);
     });
 
+    connect(window, &MainWindow::editorActivated, tabHibernator, &TabHibernator::editorActivated);
+
     // Since these editors don't actually get "closed" go ahead and add them to the recent file list
     connect(window, &MainWindow::aboutToClose, this, [=]() {
         for (const auto &editor : window->editors()) {
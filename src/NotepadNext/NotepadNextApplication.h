@@ -32,9 +32,11 @@
 class MainWindow;
 class LuaState;
 class EditorManager;
+class FileWatcher;
 class RecentFilesListManager;
 class ScintillaNext;
 class SessionManager;
+class TabHibernator;
 
 class NotepadNextApplication : public SingleApplication
 {
@@ -47,6 +49,7 @@ public:
 
     RecentFilesListManager *getRecentFilesListManager() const { return recentFilesListManager; }
     EditorManager *getEditorManager() const { return editorManager; }
+    FileWatcher *getFileWatcher() const { return fileWatcher; }
     SessionManager *getSessionManager() const;
 
     LuaState *getLuaState() const { return luaState; }
@@ -77,9 +80,11 @@ private:
     void loadSettings();
 
     EditorManager *editorManager;
+    FileWatcher *fileWatcher;
     RecentFilesListManager *recentFilesListManager;
     Settings *settings;
     SessionManager *sessionManager;
+    TabHibernator *tabHibernator;
 
     LuaState *luaState = Q_NULLPTR;
 
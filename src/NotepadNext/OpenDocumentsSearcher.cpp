@@ -0,0 +1,120 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "OpenDocumentsSearcher.h"
+#include "ISearchResultsHandler.h"
+#include "ScintillaNext.h"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+
+OpenDocumentsSearcher::OpenDocumentsSearcher(QObject *parent) :
+    BackgroundSearcher(parent)
+{
+}
+
+OpenDocumentsSearcher::~OpenDocumentsSearcher()
+{
+    waitForTasks();
+}
+
+bool OpenDocumentsSearcher::start(const QVector<ScintillaNext *> &editors, const QString &text, int searchFlags, ISearchResultsHandler *handler)
+{
+    qInfo(Q_FUNC_INFO);
+
+    if (!begin(text, searchFlags, handler)) {
+        return false;
+    }
+
+    this->editors.clear();
+    results = QVector<QVector<LineMatches>>(editors.size());
+    searchedEditors = QVector<bool>(editors.size(), false);
+    nextToReport = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < editors.size(); ++i) {
+        this->editors.append(editors[i]);
+
+        // Don't bother copying text that is going to be too long to search anyway
+        if (!editors[i]->isLoading() && !searcher->canSearch(editors[i]->length())) {
+            qWarning("Skipping \"%s\", it is too big to search this way", qUtf8Printable(editors[i]->getName()));
+            skipped++;
+            searchedEditors[i] = true;
+            continue;
+        }
+
+        // Whatever has to be copied is copied now, since the editor can be changed as soon as this returns
+        const ScintillaNext::TextSnapshot snapshot = editors[i]->textSnapshot();
+
+        queueTask([=]() {
+            const std::shared_ptr<const std::vector<char>> text = snapshot();
+            QVector<LineMatches> lines;
+
+            // Files that were not read in yet are only known to be too big now, and paged files are always too big
+            if (text && searcher->canSearch(static_cast<qint64>(text->size()))) {
+                lines = searcher->findAll(text->data(), static_cast<qint64>(text->size()), cancelled);
+                searched++;
+            }
+            else {
+                skipped++;
+            }
+
+            QMutexLocker locker(&resultsMutex);
+            results[i] = lines;
+            searchedEditors[i] = true;
+        });
+    }
+
+    qInfo("Took snapshots of %d editors in %lld ms", static_cast<int>(editors.size()), timer.elapsed());
+
+    finishQueueing();
+
+    return true;
+}
+
+void OpenDocumentsSearcher::flushResults()
+{
+    // Once the search is over anything that never got searched (i.e. it was cancelled) is just skipped
+    const bool isLastFlush = !isRunning();
+    QVector<QPair<int, QVector<LineMatches>>> batch;
+
+    {
+        QMutexLocker locker(&resultsMutex);
+
+        while (nextToReport < results.size() && (searchedEditors[nextToReport] || isLastFlush)) {
+            batch.append({nextToReport, results[nextToReport]});
+            results[nextToReport].clear();
+            nextToReport++;
+        }
+    }
+
+    for (const auto &editorResults : batch) {
+        ScintillaNext *editor = editors[editorResults.first];
+
+        // It may have been closed while it was being searched
+        if (editor && !editorResults.second.isEmpty()) {
+            handler->newFileEntry(editor);
+            reportMatches(editorResults.second);
+            matched++;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENDOCUMENTSSEARCHER_H
+#define OPENDOCUMENTSSEARCHER_H
+
+#include "BackgroundSearcher.h"
+
+#include <QMutex>
+#include <QPointer>
+#include <QVector>
+
+
+class ScintillaNext;
+
+// Searches snapshots of the text of many editors at once, so the GUI thread only has to copy text that has not been
+// saved and the editors can keep being used while the search goes on. Results are still reported in the order the
+// editors were given, no matter which one finishes first.
+class OpenDocumentsSearcher : public BackgroundSearcher
+{
+    Q_OBJECT
+
+public:
+    explicit OpenDocumentsSearcher(QObject *parent = nullptr);
+    ~OpenDocumentsSearcher() override;
+
+    // Any search still going is stopped first. Returns false if the text can't be searched for.
+    bool start(const QVector<ScintillaNext *> &editors, const QString &text, int searchFlags, ISearchResultsHandler *handler);
+    int documentCount() const { return editors.size(); }
+
+protected:
+    void flushResults() override;
+
+private:
+    QVector<QPointer<ScintillaNext>> editors;
+
+    QMutex resultsMutex;
+    QVector<QVector<LineMatches>> results;
+    QVector<bool> searchedEditors;
+    int nextToReport = 0;
+};
+
+#endif // OPENDOCUMENTSSEARCHER_H
@@ -0,0 +1,506 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "PagedFileViewer.h"
+#include "ScintillaNext.h"
+#include "TextSearcher.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+
+
+const qint64 WINDOW_SIZE = 1024 * 1024 * 8; // How much of the file is in the editor at once
+const qint64 EDGE_SIZE = 1024 * 1024; // Scrolling this close to either end of the window slides it along
+const qint64 CHUNK_SIZE = 1024 * 1024 * 64; // How much is mapped at a time when going over the whole file
+const qint64 LINES_PER_CHECKPOINT = 4096;
+
+
+// Finds the first match that starts in [from, to). Chunks overlap by the length of the text so nothing is missed in between them.
+template<typename Searcher>
+static qint64 searchFile(QFile &file, qint64 from, qint64 to, qint64 textLength, const Searcher &searcher, const std::atomic<bool> &cancelled)
+{
+    const qint64 fileSize = file.size();
+    qint64 offset = from;
+
+    while (offset < to && !cancelled) {
+        const qint64 length = qMin<qint64>(CHUNK_SIZE, to - offset);
+        const qint64 mappedLength = qMin<qint64>(length + textLength - 1, fileSize - offset);
+        uchar *data = file.map(offset, mappedLength);
+
+        if (data == Q_NULLPTR) {
+            qWarning("Unable to map \"%s\" at %lld: %s", qUtf8Printable(file.fileName()), offset, qUtf8Printable(file.errorString()));
+            return -1;
+        }
+
+        const char *begin = reinterpret_cast<const char *>(data);
+        const char *found = std::search(begin, begin + mappedLength, searcher);
+        const qint64 match = found != begin + mappedLength ? offset + (found - begin) : -1;
+
+        file.unmap(data);
+
+        if (match != -1) {
+            return match < to ? match : -1;
+        }
+
+        offset += length;
+    }
+
+    return -1;
+}
+
+template<typename Searcher>
+static qint64 searchFileWrapped(QFile &file, qint64 from, qint64 textLength, const Searcher &searcher, const std::atomic<bool> &cancelled)
+{
+    const qint64 match = searchFile(file, from, file.size(), textLength, searcher, cancelled);
+
+    if (match != -1) {
+        return match;
+    }
+
+    return searchFile(file, 0, qMin(from, file.size()), textLength, searcher, cancelled);
+}
+
+
+PagedFileViewer::PagedFileViewer(ScintillaNext *editor, const QString &filePath) :
+    QObject(editor),
+    editor(editor),
+    file(filePath)
+{
+    // One for the index and one for searching
+    pool.setMaxThreadCount(2);
+}
+
+PagedFileViewer::~PagedFileViewer()
+{
+    if (indexCancelled) {
+        *indexCancelled = true;
+    }
+
+    if (findCancelled) {
+        *findCancelled = true;
+    }
+
+    // The workers post their results back to this object
+    pool.waitForDone();
+}
+
+bool PagedFileViewer::open()
+{
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning("Unable to open \"%s\": %s", qUtf8Printable(file.fileName()), qUtf8Printable(file.errorString()));
+        return false;
+    }
+
+    size = file.size();
+
+    qInfo("Viewing \"%s\" (%lld bytes) %lld bytes at a time", qUtf8Printable(file.fileName()), size, WINDOW_SIZE);
+
+    // The line numbers of the file rather than the window are put in the margin
+    editor->setMarginTypeN(0, SC_MARGIN_RTEXT);
+
+    connect(editor, &ScintillaNext::updateUi, this, [=](Scintilla::Update updated) {
+        if (!moving && FlagSet(updated, Scintilla::Update::VScroll)) {
+            editorScrolled();
+        }
+    });
+
+    loadWindow(0);
+    startIndexing();
+
+    return true;
+}
+
+qint64 PagedFileViewer::lineAt(qint64 offset) const
+{
+    if (offset > indexedBytes) {
+        return -1;
+    }
+
+    const auto checkpoint = std::upper_bound(checkpoints.constBegin(), checkpoints.constEnd(), offset) - 1;
+    const qint64 checkpointLine = (checkpoint - checkpoints.constBegin()) * LINES_PER_CHECKPOINT;
+
+    return checkpointLine + countLines(*checkpoint, offset);
+}
+
+void PagedFileViewer::goToOffset(qint64 offset)
+{
+    showOffset(qBound<qint64>(0, offset, size), 0);
+}
+
+bool PagedFileViewer::goToLine(qint64 line)
+{
+    const qint64 offset = offsetOfLine(line);
+
+    if (offset == -1) {
+        return false;
+    }
+
+    showOffset(offset, 0);
+
+    return true;
+}
+
+void PagedFileViewer::find(const QByteArray &text, bool matchCase)
+{
+    if (findCancelled) {
+        *findCancelled = true;
+    }
+
+    if (text.isEmpty()) {
+        emit findFinished(-1);
+        return;
+    }
+
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    findCancelled = cancelled;
+
+    const QString filePath = file.fileName();
+    const qint64 from = start + editor->selectionEnd();
+
+    pool.start([=]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        QFile f(filePath);
+        qint64 match = -1;
+
+        if (f.open(QIODevice::ReadOnly)) {
+            if (matchCase) {
+                const std::boyer_moore_horspool_searcher<const char *> searcher(text.constBegin(), text.constEnd());
+                match = searchFileWrapped(f, from, text.size(), searcher, *cancelled);
+            }
+            else {
+                const std::boyer_moore_horspool_searcher<const char *, CaseInsensitiveHash, CaseInsensitiveEqual> searcher(text.constBegin(), text.constEnd());
+                match = searchFileWrapped(f, from, text.size(), searcher, *cancelled);
+            }
+        }
+
+        qInfo("Searched \"%s\" in %lld ms", qUtf8Printable(filePath), timer.elapsed());
+
+        QMetaObject::invokeMethod(this, [=]() {
+            if (*cancelled) {
+                return;
+            }
+
+            if (match != -1) {
+                showOffset(match, text.size());
+            }
+
+            emit findFinished(match);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void PagedFileViewer::refresh()
+{
+    // The file may have been replaced rather than changed, so don't keep looking at the old one
+    file.close();
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning("Unable to open \"%s\": %s", qUtf8Printable(file.fileName()), qUtf8Printable(file.errorString()));
+        return;
+    }
+
+    size = file.size();
+
+    loadWindow(qMin(start, size));
+    startIndexing();
+}
+
+void PagedFileViewer::loadWindow(qint64 offset)
+{
+    // Centered on the offset so there is room to scroll either way
+    const qint64 windowBegin = qBound<qint64>(0, offset - WINDOW_SIZE / 2, qMax<qint64>(0, size - WINDOW_SIZE));
+    const qint64 length = qMin<qint64>(WINDOW_SIZE, size - windowBegin);
+
+    uchar *data = length > 0 ? file.map(windowBegin, length) : Q_NULLPTR;
+    const char *first = reinterpret_cast<const char *>(data);
+    const char *last = first + length;
+
+    if (data == Q_NULLPTR && length > 0) {
+        qWarning("Unable to map \"%s\" at %lld: %s", qUtf8Printable(file.fileName()), windowBegin, qUtf8Printable(file.errorString()));
+        return;
+    }
+
+    // Start and end on whole lines, unless a single line is bigger than the whole window
+    if (windowBegin > 0) {
+        const char *newline = static_cast<const char *>(memchr(first, '\n', length));
+
+        if (newline) {
+            first = newline + 1;
+        }
+    }
+
+    if (windowBegin + length < size) {
+        const auto newline = std::find(std::make_reverse_iterator(last), std::make_reverse_iterator(first), '\n');
+
+        if (newline.base() != first) {
+            last = newline.base();
+        }
+    }
+
+    start = windowBegin + (first - reinterpret_cast<const char *>(data));
+    end = windowBegin + (last - reinterpret_cast<const char *>(data));
+
+    moving = true;
+
+    editor->setReadOnly(false);
+    editor->setUndoCollection(false);
+    editor->marginTextClearAll();
+    editor->setTargetRange(0, editor->length());
+    editor->replaceTarget(last - first, first);
+    editor->emptyUndoBuffer();
+    editor->setSavePoint();
+    editor->setReadOnly(true);
+
+    moving = false;
+
+    if (data) {
+        file.unmap(data);
+    }
+
+    firstLine = lineAt(start);
+    labelVisibleLines();
+
+    emit windowMoved(start, end);
+}
+
+void PagedFileViewer::showOffset(qint64 offset, qint64 length)
+{
+    if (offset < start || offset + length > end || (start > 0 && offset - start < EDGE_SIZE) || (end < size && end - offset < EDGE_SIZE)) {
+        loadWindow(offset);
+    }
+
+    editor->goToRange({static_cast<Sci_Position>(offset - start), static_cast<Sci_Position>(offset + length - start)});
+    editor->verticalCentreCaret();
+    labelVisibleLines();
+}
+
+void PagedFileViewer::editorScrolled()
+{
+    const Sci_Position firstVisibleLine = editor->firstVisibleLine();
+    const Sci_Position topPosition = editor->positionFromLine(editor->docLineFromVisible(firstVisibleLine));
+    const Sci_Position bottomPosition = editor->positionFromLine(editor->docLineFromVisible(firstVisibleLine + editor->linesOnScreen()));
+
+    const bool nearStart = start > 0 && topPosition < EDGE_SIZE;
+    const bool nearEnd = end < size && editor->length() - bottomPosition < EDGE_SIZE;
+
+    if (nearStart || nearEnd) {
+        // Keep the same line at the top and the caret where it was, as long as it is still in the window
+        const qint64 top = start + topPosition;
+        const qint64 caret = start + editor->currentPos();
+
+        loadWindow(top);
+
+        editor->setEmptySelection(caret >= start && caret <= end ? caret - start : top - start);
+        editor->setFirstVisibleLine(editor->visibleFromDocLine(editor->lineFromPosition(top - start)));
+    }
+
+    labelVisibleLines();
+}
+
+void PagedFileViewer::labelVisibleLines()
+{
+    if (firstLine == -1) {
+        return;
+    }
+
+    const Sci_Position firstVisibleLine = editor->firstVisibleLine();
+    const Sci_Position top = editor->docLineFromVisible(firstVisibleLine);
+    const Sci_Position bottom = qMin<Sci_Position>(editor->docLineFromVisible(firstVisibleLine + editor->linesOnScreen()), editor->lineCount() - 1);
+
+    for (Sci_Position line = top; line <= bottom; ++line) {
+        editor->marginSetText(line, QByteArray::number(firstLine + line + 1).constData());
+        editor->marginSetStyle(line, STYLE_LINENUMBER);
+    }
+
+    // Wide enough for the last line of the file, or as much of it as is known
+    const int digits = QByteArray::number(qMax(indexedLines, firstLine + editor->lineCount())).size();
+    editor->setMarginWidthN(0, 8 + qMax(digits, 3) * editor->textWidth(STYLE_LINENUMBER, "8"));
+}
+
+qint64 PagedFileViewer::countLines(qint64 from, qint64 to) const
+{
+    QFile &f = file;
+    qint64 lines = 0;
+
+    for (qint64 offset = from; offset < to; offset += CHUNK_SIZE) {
+        const qint64 length = qMin<qint64>(CHUNK_SIZE, to - offset);
+        uchar *data = f.map(offset, length);
+
+        if (data == Q_NULLPTR) {
+            return -1;
+        }
+
+        const char *begin = reinterpret_cast<const char *>(data);
+        lines += std::count(begin, begin + length, '\n');
+
+        f.unmap(data);
+    }
+
+    return lines;
+}
+
+qint64 PagedFileViewer::offsetOfLine(qint64 line) const
+{
+    const qint64 checkpoint = line / LINES_PER_CHECKPOINT;
+
+    if (line < 0 || checkpoint >= checkpoints.size()) {
+        return -1;
+    }
+
+    QFile &f = file;
+    qint64 remaining = line % LINES_PER_CHECKPOINT;
+    qint64 offset = checkpoints.at(checkpoint);
+
+    // The rest of the way is never more than LINES_PER_CHECKPOINT lines
+    while (remaining > 0 && offset < size) {
+        const qint64 length = qMin<qint64>(CHUNK_SIZE, size - offset);
+        uchar *data = f.map(offset, length);
+
+        if (data == Q_NULLPTR) {
+            return -1;
+        }
+
+        const char *begin = reinterpret_cast<const char *>(data);
+        const char *p = begin;
+
+        while (remaining > 0 && (p = static_cast<const char *>(memchr(p, '\n', begin + length - p))) != Q_NULLPTR) {
+            ++p;
+            --remaining;
+        }
+
+        f.unmap(data);
+
+        if (remaining == 0) {
+            return offset + (p - begin);
+        }
+
+        offset += length;
+    }
+
+    return remaining == 0 ? offset : -1;
+}
+
+void PagedFileViewer::startIndexing()
+{
+    if (indexCancelled) {
+        *indexCancelled = true;
+    }
+
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    indexCancelled = cancelled;
+
+    checkpoints = {0};
+    indexedBytes = 0;
+    indexedLines = 0;
+    indexed = false;
+
+    pool.start([=]() { buildIndex(cancelled); });
+}
+
+void PagedFileViewer::buildIndex(std::shared_ptr<std::atomic<bool>> cancelled)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile f(file.fileName());
+
+    if (!f.open(QIODevice::ReadOnly)) {
+        qWarning("Unable to index \"%s\": %s", qUtf8Printable(f.fileName()), qUtf8Printable(f.errorString()));
+        return;
+    }
+
+    const qint64 totalBytes = f.size();
+    qint64 offset = 0;
+    qint64 lines = 0;
+
+    while (offset < totalBytes && !*cancelled) {
+        const qint64 length = qMin<qint64>(CHUNK_SIZE, totalBytes - offset);
+        uchar *data = f.map(offset, length);
+
+        if (data == Q_NULLPTR) {
+            qWarning("Unable to map \"%s\" at %lld: %s", qUtf8Printable(f.fileName()), offset, qUtf8Printable(f.errorString()));
+            return;
+        }
+
+        const char *begin = reinterpret_cast<const char *>(data);
+        const char *p = begin;
+        QVector<qint64> found;
+
+        while ((p = static_cast<const char *>(memchr(p, '\n', begin + length - p))) != Q_NULLPTR) {
+            ++p;
+            ++lines;
+
+            if (lines % LINES_PER_CHECKPOINT == 0) {
+                found.append(offset + (p - begin));
+            }
+        }
+
+        f.unmap(data);
+        offset += length;
+
+        const qint64 bytesIndexed = offset;
+        const qint64 linesIndexed = lines;
+
+        QMetaObject::invokeMethod(this, [=]() {
+            if (*cancelled) {
+                return;
+            }
+
+            checkpoints += found;
+            indexedBytes = bytesIndexed;
+            indexedLines = linesIndexed;
+
+            // The window's line numbers are known as soon as the index gets to it
+            if (firstLine == -1 && indexedBytes >= start) {
+                firstLine = lineAt(start);
+                labelVisibleLines();
+            }
+
+            emit indexProgress(static_cast<int>(bytesIndexed * 100 / totalBytes));
+        }, Qt::QueuedConnection);
+    }
+
+    if (*cancelled) {
+        return;
+    }
+
+    qInfo("Indexed %lld lines of \"%s\" in %lld ms", lines + 1, qUtf8Printable(f.fileName()), timer.elapsed());
+
+    QMetaObject::invokeMethod(this, [=]() {
+        if (*cancelled) {
+            return;
+        }
+
+        indexed = true;
+        indexedLines = lines + 1;
+
+        if (firstLine == -1) {
+            firstLine = lineAt(start);
+            labelVisibleLines();
+        }
+
+        emit indexFinished(indexedLines);
+    }, Qt::QueuedConnection);
+}
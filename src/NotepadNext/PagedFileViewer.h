@@ -0,0 +1,109 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PAGEDFILEVIEWER_H
+#define PAGEDFILEVIEWER_H
+
+#include <QFile>
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+
+
+class ScintillaNext;
+
+// Shows a file that is too big to ever be read into a document. The editor only holds a window of the file
+// at a time, which slides along as the editor is scrolled near either end of it. Where every so many lines
+// start is indexed in the background so lines can be gone to without reading everything in front of them.
+// The file is only ever looked at through memory mapped chunks, so none of it has to stay in memory.
+class PagedFileViewer : public QObject
+{
+    Q_OBJECT
+
+public:
+    PagedFileViewer(ScintillaNext *editor, const QString &filePath);
+    ~PagedFileViewer() override;
+
+    bool open();
+
+    qint64 fileSize() const { return size; }
+    qint64 windowStart() const { return start; }
+    qint64 windowEnd() const { return end; }
+
+    // How many lines have been indexed so far, which is all of them once isIndexed()
+    qint64 indexedLineCount() const { return indexedLines; }
+    bool isIndexed() const { return indexed; }
+
+    // The 0-based line the offset is on, or -1 if the index has not got that far yet
+    qint64 lineAt(qint64 offset) const;
+
+public slots:
+    void goToOffset(qint64 offset);
+    bool goToLine(qint64 line);
+
+    // Looks for the text after the caret, wrapping around to the start of the file. See findFinished().
+    void find(const QByteArray &text, bool matchCase);
+
+    // The file changed on disk, so the window and the index are out of date
+    void refresh();
+
+signals:
+    void indexProgress(int percent);
+    void indexFinished(qint64 lineCount);
+    void windowMoved(qint64 start, qint64 end);
+
+    // The offset of the match, or -1 if there is none
+    void findFinished(qint64 offset);
+
+private:
+    void loadWindow(qint64 offset);
+    void showOffset(qint64 offset, qint64 length);
+    void editorScrolled();
+    void labelVisibleLines();
+    qint64 countLines(qint64 from, qint64 to) const;
+    qint64 offsetOfLine(qint64 line) const;
+
+    void startIndexing();
+    void buildIndex(std::shared_ptr<std::atomic<bool>> cancelled);
+
+    ScintillaNext *editor;
+    mutable QFile file; // Mapping is not const
+    qint64 size = 0;
+
+    // The part of the file that is in the editor
+    qint64 start = 0;
+    qint64 end = 0;
+    qint64 firstLine = -1;
+    bool moving = false;
+
+    // Offsets of every LINES_PER_CHECKPOINT'th line, starting with line 0
+    QVector<qint64> checkpoints;
+    qint64 indexedBytes = 0;
+    qint64 indexedLines = 0;
+    bool indexed = false;
+
+    QThreadPool pool;
+    std::shared_ptr<std::atomic<bool>> indexCancelled;
+    std::shared_ptr<std::atomic<bool>> findCancelled;
+};
+
+#endif // PAGEDFILEVIEWER_H
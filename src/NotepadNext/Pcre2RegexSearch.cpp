@@ -0,0 +1,296 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2019 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Pcre2RegexSearch.h"
+
+#ifdef USE_PCRE2_REGEX
+
+using namespace Scintilla;
+
+static bool isLineEnd(char c)
+{
+    return c == '\n' || c == '\r';
+}
+
+Pcre2RegexSearch::Pcre2RegexSearch()
+{
+
+}
+
+Pcre2RegexSearch::~Pcre2RegexSearch()
+{
+    release();
+
+    pcre2_match_context_free(matchContext);
+    pcre2_jit_stack_free(jitStack);
+}
+
+Sci::Position Pcre2RegexSearch::FindText(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s, bool caseSensitive, bool word, bool wordStart, Scintilla::FindOption flags, Sci::Position *length)
+{
+    Q_UNUSED(caseSensitive);
+    Q_UNUSED(word);
+    Q_UNUSED(wordStart);
+
+    // Scintilla asks for a backwards search by giving the range the other way round
+    const bool backwards = minPos > maxPos;
+    Sci::Position rangeStart = backwards ? maxPos : minPos;
+    Sci::Position rangeEnd = backwards ? minPos : maxPos;
+
+    rangeStart = doc->MovePositionOutsideChar(rangeStart, 1, false);
+    rangeEnd = doc->MovePositionOutsideChar(rangeEnd, -1, false);
+
+    // No need to search an empty range
+    if (rangeStart >= rangeEnd)
+        return -1;
+
+    uint32_t options = PCRE2_UTF | PCRE2_UCP | PCRE2_MULTILINE;
+
+#ifdef PCRE2_MATCH_INVALID_UTF
+    // Documents aren't guaranteed to be valid UTF-8, this makes the invalid bytes just not match instead of an error
+    options |= PCRE2_MATCH_INVALID_UTF;
+#endif
+
+    if (!FlagSet(flags, FindOption::MatchCase))
+        options |= PCRE2_CASELESS;
+
+    if (!compile(s, options))
+        return -1; // Invalid regular expression
+
+    Sci::Position position = findForward(doc, rangeStart, rangeEnd);
+
+    if (backwards) {
+        // Keep the last match in the range
+        Sci::Position lastPosition = -1;
+        std::vector<std::pair<Sci::Position, Sci::Position>> lastGroups;
+
+        while (position != -1) {
+            lastPosition = position;
+            lastGroups = groups;
+
+            const Sci::Position matchEnd = groups[0].second;
+            const Sci::Position next = matchEnd == position ? doc->NextPosition(matchEnd, 1) : matchEnd;
+            if (next >= rangeEnd)
+                break;
+
+            position = findForward(doc, next, rangeEnd);
+        }
+
+        position = lastPosition;
+        groups = lastGroups;
+    }
+
+    if (position == -1)
+        return -1; // No match
+
+    *length = groups[0].second - groups[0].first;
+
+    return position;
+}
+
+const char *Pcre2RegexSearch::SubstituteByPosition(Document *doc, const char *text, Sci::Position *length)
+{
+    // Same syntax as Scintilla's own engine: \0 to \9 for the groups, and the usual character escapes
+    substituted.clear();
+
+    for (Sci::Position j = 0; j < *length; j++) {
+        if (text[j] == '\\' && j + 1 < *length) {
+            const char next = text[++j];
+
+            if (next >= '0' && next <= '9') {
+                const size_t group = next - '0';
+
+                // Groups that did not take part in the match are left out
+                if (group < groups.size() && groups[group].first != -1) {
+                    const Sci::Position groupLength = groups[group].second - groups[group].first;
+                    const size_t offset = substituted.size();
+
+                    substituted.resize(offset + groupLength);
+                    doc->GetCharRange(&substituted[offset], groups[group].first, groupLength);
+                }
+            }
+            else {
+                switch (next) {
+                case 'a':
+                    substituted.push_back('\a');
+                    break;
+                case 'b':
+                    substituted.push_back('\b');
+                    break;
+                case 'f':
+                    substituted.push_back('\f');
+                    break;
+                case 'n':
+                    substituted.push_back('\n');
+                    break;
+                case 'r':
+                    substituted.push_back('\r');
+                    break;
+                case 't':
+                    substituted.push_back('\t');
+                    break;
+                case 'v':
+                    substituted.push_back('\v');
+                    break;
+                case '\\':
+                    substituted.push_back('\\');
+                    break;
+                default:
+                    substituted.push_back('\\');
+                    j--;
+                }
+            }
+        }
+        else {
+            substituted.push_back(text[j]);
+        }
+    }
+
+    *length = substituted.length();
+    return substituted.c_str();
+}
+
+bool Pcre2RegexSearch::compile(const char *s, uint32_t options)
+{
+    if (code && patternOptions == options && pattern == s)
+        return true;
+
+    release();
+
+    int errorCode = 0;
+    PCRE2_SIZE errorOffset = 0;
+
+    code = pcre2_compile(reinterpret_cast<PCRE2_SPTR>(s), PCRE2_ZERO_TERMINATED, options, &errorCode, &errorOffset, Q_NULLPTR);
+
+    if (!code) {
+        PCRE2_UCHAR message[256];
+        pcre2_get_error_message(errorCode, message, sizeof(message));
+        qWarning("Invalid regular expression at offset %zu: %s", static_cast<size_t>(errorOffset), reinterpret_cast<const char *>(message));
+
+        return false;
+    }
+
+    // When JIT isn't supported on this platform, or PCRE2 was built without it, pcre2_match() uses the interpreter instead
+    if (pcre2_jit_compile(code, PCRE2_JIT_COMPLETE | PCRE2_JIT_PARTIAL_HARD) == 0 && !jitStack) {
+        // The default 32K of stack runs out quickly on patterns that backtrack a lot
+        jitStack = pcre2_jit_stack_create(32 * 1024, 1024 * 1024, Q_NULLPTR);
+        matchContext = pcre2_match_context_create(Q_NULLPTR);
+        pcre2_jit_stack_assign(matchContext, Q_NULLPTR, jitStack);
+    }
+
+    if (pcre2_pattern_info(code, PCRE2_INFO_MAXLOOKBEHIND, &lookbehind) != 0)
+        lookbehind = 0;
+
+    matchData = pcre2_match_data_create_from_pattern(code, Q_NULLPTR);
+    pattern = s;
+    patternOptions = options;
+
+    return true;
+}
+
+void Pcre2RegexSearch::release()
+{
+    pcre2_match_data_free(matchData);
+    pcre2_code_free(code);
+
+    matchData = Q_NULLPTR;
+    code = Q_NULLPTR;
+    pattern.clear();
+}
+
+Sci::Position Pcre2RegexSearch::findForward(Document *doc, Sci::Position start, Sci::Position end)
+{
+    const Sci::Position gap = doc->GapPosition();
+
+    if (start < gap && end > gap) {
+        // Search the text before the gap, but stop at the gap with a partial match if a match might carry on past it
+        const Sci::Position subjectStart = contextStart(doc, start);
+        const int rc = matchSubject(doc, subjectStart, gap, start - subjectStart, PCRE2_PARTIAL_HARD);
+
+        if (rc >= 0)
+            return groups[0].first;
+
+        if (rc == PCRE2_ERROR_PARTIAL) {
+            // Reading from (just before) the start of the partial match moves the gap out of the way, so the rest of it
+            // can be read in one piece. There was no complete match before it, so the first match from there on is the answer.
+            const Sci::Position partialStart = groups[0].first;
+            const Sci::Position partialSubjectStart = contextStart(doc, partialStart);
+
+            return matchSubject(doc, partialSubjectStart, end, partialStart - partialSubjectStart, 0) >= 0 ? groups[0].first : -1;
+        }
+
+        if (rc != PCRE2_ERROR_NOMATCH)
+            return -1;
+
+        // Nothing starts before the gap, carry on after it
+        start = gap;
+    }
+
+    // Starting just after the gap still needs the text before it for lookbehinds, which moves the gap back by that much
+    const Sci::Position subjectStart = contextStart(doc, start);
+
+    return matchSubject(doc, subjectStart, end, start - subjectStart, 0) >= 0 ? groups[0].first : -1;
+}
+
+Sci::Position Pcre2RegexSearch::contextStart(Document *doc, Sci::Position position) const
+{
+    // A UTF-8 character is at most 4 bytes. The subject has to start on a character, or it isn't valid UTF-8.
+    const Sci::Position context = qMin<Sci::Position>(position, static_cast<Sci::Position>(lookbehind) * 4);
+
+    return doc->MovePositionOutsideChar(position - context, -1, false);
+}
+
+int Pcre2RegexSearch::matchSubject(Document *doc, Sci::Position subjectStart, Sci::Position subjectEnd, Sci::Position offset, uint32_t options)
+{
+    // Neither end of the subject is necessarily the end of a line, so don't let ^ and $ match there if it isn't
+    if (subjectStart > 0 && !isLineEnd(doc->CharAt(subjectStart - 1)))
+        options |= PCRE2_NOTBOL;
+    if (subjectEnd < doc->Length() && !isLineEnd(doc->CharAt(subjectEnd)))
+        options |= PCRE2_NOTEOL;
+
+    // This does not move the gap unless the subject spans it
+    const char *subject = doc->RangePointer(subjectStart, subjectEnd - subjectStart);
+
+    const int rc = pcre2_match(code, reinterpret_cast<PCRE2_SPTR>(subject), subjectEnd - subjectStart, offset, options, matchData, matchContext);
+
+    if (rc < 0 && rc != PCRE2_ERROR_PARTIAL) {
+        if (rc != PCRE2_ERROR_NOMATCH) {
+            PCRE2_UCHAR message[256];
+            pcre2_get_error_message(rc, message, sizeof(message));
+            qWarning("Regular expression search failed: %s", reinterpret_cast<const char *>(message));
+        }
+
+        return rc;
+    }
+
+    // A partial match only sets the first pair
+    const PCRE2_SIZE *ovector = pcre2_get_ovector_pointer(matchData);
+    const uint32_t pairs = rc == PCRE2_ERROR_PARTIAL ? 1 : pcre2_get_ovector_count(matchData);
+
+    groups.clear();
+    for (uint32_t i = 0; i < pairs; ++i) {
+        if (ovector[2 * i] == PCRE2_UNSET)
+            groups.emplace_back(-1, -1);
+        else
+            groups.emplace_back(subjectStart + ovector[2 * i], subjectStart + ovector[2 * i + 1]);
+    }
+
+    return rc;
+}
+
+#endif // USE_PCRE2_REGEX
@@ -0,0 +1,122 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2019 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PCRE2REGEXSEARCH_H
+#define PCRE2REGEXSEARCH_H
+
+#ifdef USE_PCRE2_REGEX
+
+#include <QtGlobal>
+
+#include <pcre2.h>
+
+// TODO: Fix this mess. Scintilla makes you include everything...in the correct order...
+// this was copied from Editor.cxx just to get it to compile
+
+
+#include <cstddef>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <set>
+#include <forward_list>
+#include <optional>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <chrono>
+
+#include "ScintillaTypes.h"
+#include "ScintillaMessages.h"
+#include "ScintillaStructures.h"
+#include "ILoader.h"
+#include "ILexer.h"
+
+#include "Debugging.h"
+#include "Geometry.h"
+#include "Platform.h"
+
+#include "CharacterType.h"
+#include "CharacterCategoryMap.h"
+#include "Position.h"
+#include "UniqueString.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "ContractionState.h"
+#include "CellBuffer.h"
+#include "PerLine.h"
+#include "KeyMap.h"
+#include "Indicator.h"
+#include "LineMarker.h"
+#include "Style.h"
+#include "ViewStyle.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "Scintilla.h"
+
+using namespace Scintilla::Internal;
+
+// Matches the document's UTF-8 bytes directly with PCRE2, instead of converting them to UTF-16 for QRegularExpression.
+// The text is read where it is in the gap buffer. The gap is only moved when a match might cross it, and then only
+// as far as the start of that match (less however far back the pattern can look).
+class Pcre2RegexSearch : public RegexSearchBase
+{
+public:
+    Pcre2RegexSearch();
+    ~Pcre2RegexSearch() override;
+
+    Sci::Position FindText(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s, bool caseSensitive, bool word, bool wordStart, Scintilla::FindOption flags, Sci::Position *length) override;
+    const char *SubstituteByPosition(Document *doc, const char *text, Sci::Position *length) override;
+
+private:
+    bool compile(const char *s, uint32_t options);
+    void release();
+
+    Sci::Position findForward(Document *doc, Sci::Position start, Sci::Position end);
+    Sci::Position contextStart(Document *doc, Sci::Position position) const;
+    int matchSubject(Document *doc, Sci::Position subjectStart, Sci::Position subjectEnd, Sci::Position offset, uint32_t options);
+
+    // The last pattern is kept compiled, since the same one is used over and over to find every match
+    std::string pattern;
+    uint32_t patternOptions = 0;
+    pcre2_code *code = Q_NULLPTR;
+    pcre2_match_data *matchData = Q_NULLPTR;
+    pcre2_match_context *matchContext = Q_NULLPTR;
+    pcre2_jit_stack *jitStack = Q_NULLPTR;
+    uint32_t lookbehind = 0; // In characters, how far back the pattern can look from where a match starts (e.g. \b needs 1)
+
+    // Document positions of the groups of the last match, -1 for groups that did not take part
+    std::vector<std::pair<Sci::Position, Sci::Position>> groups;
+    std::string substituted;
+};
+
+#endif // USE_PCRE2_REGEX
+
+#endif // PCRE2REGEXSEARCH_H
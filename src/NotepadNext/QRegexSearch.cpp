@@ -18,12 +18,25 @@
 
 
 #include "QRegexSearch.h"
+#include "Pcre2RegexSearch.h"
+#include "Utf8Validator.h"
 
 #include <QtGlobal>
-#include <QRegularExpression>
+#include <QList>
+#include <QMutex>
+#include <QStringView>
 
 using namespace Scintilla;
 
+// How many compiled expressions are kept around for reuse
+static constexpr int MaxCachedExpressions = 16;
+
+// How many UTF-16 indexes apart the byte offset checkpoints are
+static constexpr qsizetype CheckpointInterval = 1024;
+
+// How much of the text before an edit is decoded again so ^, \b and lookbehinds see what is there now
+static constexpr Sci::Position ContextBytes = 1024;
+
 #ifdef SCI_OWNREGEX
 RegexSearchBase *Scintilla::Internal::CreateRegexSearch(CharClassify *charClassTable)
 {
@@ -31,15 +44,69 @@ RegexSearchBase *Scintilla::Internal::CreateRegexSearch(CharClassify *charClassT
 
     qInfo(Q_FUNC_INFO);
 
+#ifdef USE_PCRE2_REGEX
+    return new Pcre2RegexSearch();
+#else
     return new QRegexSearch();
+#endif
 }
 #endif
 
+// Number of bytes the character takes in UTF-8. A surrogate pair counts all 4 bytes on the high surrogate
+static int utf8Width(QChar c)
+{
+    const ushort u = c.unicode();
+
+    if (u < 0x80)
+        return 1;
+    else if (u < 0x800)
+        return 2;
+    else if (QChar::isHighSurrogate(u))
+        return 4;
+    else if (QChar::isLowSurrogate(u))
+        return 0;
+    else
+        return 3;
+}
+
+// Matches against text from index from up to index to only, without copying it. The offset is an index into text.
+static QRegularExpressionMatch matchSubview(const QRegularExpression &re, const QString &text, qsizetype from, qsizetype to, qsizetype offset)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    return re.matchView(QStringView(text).mid(from, to - from), offset - from);
+#elif QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return re.match(QStringView(text).mid(from, to - from), offset - from);
+#else
+    return re.match(text.midRef(from, to - from), offset - from);
+#endif
+}
+
+// Where in text the whole match from matchSubview() starts
+static qsizetype matchStart(const QRegularExpressionMatch &m, qsizetype from)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return from + m.capturedStart(0);
+#else
+    // A string reference knows where it is in the whole string, whichever way the match counts its offsets
+    Q_UNUSED(from);
+    return m.capturedRef(0).position();
+#endif
+}
+
 QRegexSearch::QRegexSearch()
 {
 
 }
 
+QRegexSearch::~QRegexSearch()
+{
+    if (watchedDoc) {
+        watchedDoc->RemoveWatcher(this, Q_NULLPTR);
+    }
+
+    delete substituted;
+}
+
 Sci::Position QRegexSearch::FindText(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s, bool caseSensitive, bool word, bool wordStart, Scintilla::FindOption flags, Sci::Position *length)
 {
     // -----------------------------------------------------------------------------------------------------------------------
@@ -48,9 +115,14 @@ Sci::Position QRegexSearch::FindText(Document *doc, Sci::Position minPos, Sci::P
     // when you start using characters that are >1 byte a piece. Meaning position 3 (3 bytes into a file) could be 1 character.
     // -----------------------------------------------------------------------------------------------------------------------
 
+    // Scintilla asks for a backwards search by giving the range the other way round
+    const bool backwards = minPos > maxPos;
+    Sci::Position rangeStart = backwards ? maxPos : minPos;
+    Sci::Position rangeEnd = backwards ? minPos : maxPos;
+
     // Make sure the positiosn are outside of characters
-    minPos = doc->MovePositionOutsideChar(minPos, 1, false);
-    maxPos = doc->MovePositionOutsideChar(maxPos, -1, false);
+    rangeStart = doc->MovePositionOutsideChar(rangeStart, 1, false);
+    rangeEnd = doc->MovePositionOutsideChar(rangeEnd, -1, false);
 
     //qInfo(Q_FUNC_INFO);
     //qInfo("\tminPos %d", minPos);
@@ -62,42 +134,43 @@ Sci::Position QRegexSearch::FindText(Document *doc, Sci::Position minPos, Sci::P
     //qInfo("\tflags %d", flags);
 
     // No need to search an empty range
-    if (minPos == maxPos)
+    if (rangeStart >= rangeEnd)
         return -1;
 
-    auto options = QRegularExpression::MultilineOption | QRegularExpression::UseUnicodePropertiesOption;
+    QRegularExpression::PatternOptions options = QRegularExpression::MultilineOption | QRegularExpression::UseUnicodePropertiesOption;
 
     if (!FlagSet(flags, FindOption::MatchCase))
         options |= QRegularExpression::CaseInsensitiveOption;
 
     // TODO: does (*ANYCRLF) need prepended to the search string?
-    QRegularExpression re(s, options);
+    const QRegularExpression re = compiledExpression(s, options);
     if (!re.isValid())
         return -1; // Invalid regular expression
 
-    // Get the bytes from the document. No need to go past maxPos bytes
-    // Not actually sure if this copies the data or not
-    const Sci::Position rangeLength = maxPos - minPos;
-    const QString utf8 = QString::fromUtf8(doc->RangePointer(minPos, rangeLength), rangeLength);
-
-    // NOTE: QString uses UTF16 counts since QChars are 16 bits
-    QRegularExpressionMatch m = re.match(utf8, 0, QRegularExpression::NormalMatch, QRegularExpression::NoMatchOption);
+    if (watchedDoc != doc) {
+        if (watchedDoc) {
+            watchedDoc->RemoveWatcher(this, Q_NULLPTR);
+        }
 
-    if (!m.hasMatch())
-        return -1; // No match
+        doc->AddWatcher(this, Q_NULLPTR);
+        watchedDoc = doc;
+        viewIsValid = false;
+    }
 
-    match = m;
+    if (!viewCovers(rangeStart, rangeEnd)) {
+        decodeDocument(doc);
+    }
 
-    // NOTE: Returned started is the index into the QString which uses UTF16
-    const int positionStart = doc->GetRelativePositionUTF16(minPos, match.capturedStart(0));
+    // The view can't be mapped back to bytes if the document isn't valid UTF-8, so just decode what is needed
+    if (!viewIsUtf8)
+        return findInRange(doc, re, rangeStart, rangeStart, rangeEnd, length);
 
-    // Now move ahead however many characters we matched. Again, based on UTF16 count
-    const int positionEnd = doc->GetRelativePositionUTF16(positionStart, match.capturedLength(0));
+    // Near the start of the document the edits may have made the text before them longer than it was, so there's no
+    // room for it in the view. Decoding it along with the range is the only way the regex sees the right text then.
+    if (!contextIsFresh && !refreshContext(doc))
+        return findInRange(doc, re, contextStart(doc, rangeStart), rangeStart, rangeEnd, length);
 
-    // The length is the number of bytes that was matched
-    *length = positionEnd - positionStart;
-
-    return positionStart;
+    return findInView(re, rangeStart, rangeEnd, backwards, length);
 }
 
 const char *QRegexSearch::SubstituteByPosition(Document *doc, const char *text, Sci::Position *length)
@@ -122,3 +195,301 @@ const char *QRegexSearch::SubstituteByPosition(Document *doc, const char *text,
     *length = substituted->length();
     return substituted->data();
 }
+
+void QRegexSearch::NotifyModifyAttempt(Document *doc, void *userData)
+{
+    Q_UNUSED(doc);
+    Q_UNUSED(userData);
+}
+
+void QRegexSearch::NotifySavePoint(Document *doc, void *userData, bool atSavePoint)
+{
+    Q_UNUSED(doc);
+    Q_UNUSED(userData);
+    Q_UNUSED(atSavePoint);
+}
+
+void QRegexSearch::NotifyModified(Document *doc, DocModification mh, void *userData)
+{
+    Q_UNUSED(doc);
+    Q_UNUSED(userData);
+
+    // Everything before the edit is given up on, everything after it is still in the view just at a different position.
+    // A replace all only ever searches after the last replacement so it keeps using the same view the whole way through.
+    // The text just before the edit still has to be decoded again though, the regex can look at it.
+    if (FlagSet(mh.modificationType, ModificationFlags::InsertText)) {
+        viewStaleBefore = std::max(viewStaleBefore, mh.position) + mh.length;
+        viewShift += mh.length;
+    }
+    else if (FlagSet(mh.modificationType, ModificationFlags::DeleteText)) {
+        viewStaleBefore = std::max(viewStaleBefore - mh.length, mh.position);
+        viewShift -= mh.length;
+    }
+    else {
+        return;
+    }
+
+    contextIsFresh = false;
+
+    // The edit may have made the document valid UTF-8, so check again next time
+    if (!viewIsUtf8) {
+        viewIsValid = false;
+    }
+}
+
+void QRegexSearch::NotifyDeleted(Document *doc, void *userData) noexcept
+{
+    Q_UNUSED(doc);
+    Q_UNUSED(userData);
+
+    watchedDoc = Q_NULLPTR;
+    viewIsValid = false;
+}
+
+void QRegexSearch::NotifyStyleNeeded(Document *doc, void *userData, Sci::Position endPos)
+{
+    Q_UNUSED(doc);
+    Q_UNUSED(userData);
+    Q_UNUSED(endPos);
+}
+
+void QRegexSearch::NotifyErrorOccurred(Document *doc, void *userData, Scintilla::Status status)
+{
+    Q_UNUSED(doc);
+    Q_UNUSED(userData);
+    Q_UNUSED(status);
+}
+
+QRegularExpression QRegexSearch::compiledExpression(const char *pattern, QRegularExpression::PatternOptions options)
+{
+    // Shared by every document, most recently used first
+    static QMutex mutex;
+    static QList<QRegularExpression> cache;
+
+    const QString patternString = QString::fromUtf8(pattern);
+    QMutexLocker locker(&mutex);
+
+    for (int i = 0; i < cache.size(); ++i) {
+        if (cache[i].patternOptions() == options && cache[i].pattern() == patternString) {
+            cache.move(i, 0);
+            return cache.first();
+        }
+    }
+
+    QRegularExpression re(patternString, options);
+
+    // Compile it now instead of on the first match, so the cached copy is the compiled one
+    re.optimize();
+
+    cache.prepend(re);
+    if (cache.size() > MaxCachedExpressions) {
+        cache.removeLast();
+    }
+
+    return re;
+}
+
+bool QRegexSearch::viewCovers(Sci::Position start, Sci::Position end) const
+{
+    return viewIsValid && start >= viewStaleBefore && end - viewShift <= viewLength;
+}
+
+void QRegexSearch::decodeDocument(Document *doc)
+{
+    // This moves the gap to the end, but only once for all the searches that use the view
+    viewLength = doc->Length();
+    const char *bytes = doc->RangePointer(0, viewLength);
+
+    Utf8Validator validator;
+    validator.validate(bytes, viewLength);
+    viewIsUtf8 = validator.finish();
+    viewIsAscii = validator.isAscii();
+
+    view.clear();
+    checkpoints.clear();
+    viewShift = 0;
+    viewStaleBefore = 0;
+    viewIsValid = true;
+    contextIsFresh = true;
+    subjectStart = 0;
+    anchorIndex = 0;
+    anchorByte = 0;
+
+    if (!viewIsUtf8)
+        return;
+
+    view = QString::fromUtf8(bytes, viewLength);
+
+    if (viewIsAscii)
+        return;
+
+    checkpoints.reserve(view.size() / CheckpointInterval + 1);
+
+    Sci::Position pos = 0;
+    for (qsizetype i = 0; i <= view.size(); ++i) {
+        if (i % CheckpointInterval == 0) {
+            checkpoints.push_back(pos);
+        }
+
+        if (i < view.size()) {
+            pos += utf8Width(view[i]);
+        }
+    }
+
+    // Should never happen for valid UTF-8, but if the decoder did something unexpected the offsets would be wrong
+    if (pos != viewLength) {
+        qWarning("Decoded view of the document is %lld bytes instead of %lld", static_cast<long long>(pos), static_cast<long long>(viewLength));
+
+        viewIsUtf8 = false;
+        view.clear();
+        checkpoints.clear();
+    }
+}
+
+qsizetype QRegexSearch::indexOfByte(Sci::Position bytePos) const
+{
+    if (viewIsAscii)
+        return bytePos;
+
+    const auto it = std::upper_bound(checkpoints.cbegin(), checkpoints.cend(), bytePos);
+    const qsizetype checkpoint = std::distance(checkpoints.cbegin(), it) - 1;
+
+    qsizetype index = checkpoint * CheckpointInterval;
+    Sci::Position pos = checkpoints[checkpoint];
+
+    // The text before the anchor may have been overwritten by refreshContext() so don't count through it
+    if (index < anchorIndex) {
+        index = anchorIndex;
+        pos = anchorByte;
+    }
+
+    while (pos < bytePos) {
+        pos += utf8Width(view[index++]);
+    }
+
+    // Step past the second half of a surrogate pair, the bytes were already counted on the first half
+    while (index < view.size() && view[index].isLowSurrogate()) {
+        ++index;
+    }
+
+    return index;
+}
+
+Sci::Position QRegexSearch::byteOfIndex(qsizetype index) const
+{
+    if (viewIsAscii)
+        return index;
+
+    const qsizetype checkpoint = index / CheckpointInterval;
+
+    qsizetype i = checkpoint * CheckpointInterval;
+    Sci::Position pos = checkpoints[checkpoint];
+
+    if (i < anchorIndex) {
+        i = anchorIndex;
+        pos = anchorByte;
+    }
+
+    while (i < index) {
+        pos += utf8Width(view[i++]);
+    }
+
+    return pos;
+}
+
+Sci::Position QRegexSearch::findInView(const QRegularExpression &re, Sci::Position rangeStart, Sci::Position rangeEnd, bool backwards, Sci::Position *length)
+{
+    const qsizetype start = indexOfByte(rangeStart - viewShift);
+    const qsizetype end = indexOfByte(rangeEnd - viewShift);
+
+    // NOTE: The match sees the text before the start, so ^ and lookbehinds behave the same as when searching the whole
+    // document. Nothing past the end of the range is visible to it though, and nothing before subjectStart.
+    QRegularExpressionMatch m = matchSubview(re, view, subjectStart, end, start);
+
+    if (backwards) {
+        // Keep the last match in the range
+        QRegularExpressionMatch next = m;
+        while (next.hasMatch()) {
+            m = next;
+
+            const qsizetype offset = matchStart(next, subjectStart) + next.capturedLength(0) + (next.capturedLength(0) == 0 ? 1 : 0);
+            if (offset > end)
+                break;
+
+            next = matchSubview(re, view, subjectStart, end, offset);
+        }
+    }
+
+    if (!m.hasMatch())
+        return -1; // No match
+
+    match = m;
+
+    const qsizetype matchedStart = matchStart(match, subjectStart);
+    const Sci::Position positionStart = byteOfIndex(matchedStart) + viewShift;
+    const Sci::Position positionEnd = byteOfIndex(matchedStart + match.capturedLength(0)) + viewShift;
+
+    // The length is the number of bytes that was matched
+    *length = positionEnd - positionStart;
+
+    return positionStart;
+}
+
+Sci::Position QRegexSearch::findInRange(Document *doc, const QRegularExpression &re, Sci::Position subjectStart, Sci::Position rangeStart, Sci::Position rangeEnd, Sci::Position *length)
+{
+    // Get the bytes from the document. No need to go past rangeEnd bytes
+    const Sci::Position subjectLength = rangeEnd - subjectStart;
+    const QString utf8 = QString::fromUtf8(doc->RangePointer(subjectStart, subjectLength), subjectLength);
+
+    // NOTE: QString uses UTF16 counts since QChars are 16 bits
+    const qsizetype offset = doc->CountUTF16(subjectStart, rangeStart);
+    QRegularExpressionMatch m = re.match(utf8, offset, QRegularExpression::NormalMatch, QRegularExpression::NoMatchOption);
+
+    if (!m.hasMatch())
+        return -1; // No match
+
+    match = m;
+
+    // NOTE: Returned started is the index into the QString which uses UTF16
+    const Sci::Position positionStart = doc->GetRelativePositionUTF16(subjectStart, match.capturedStart(0));
+
+    // Now move ahead however many characters we matched. Again, based on UTF16 count
+    const Sci::Position positionEnd = doc->GetRelativePositionUTF16(positionStart, match.capturedLength(0));
+
+    // The length is the number of bytes that was matched
+    *length = positionEnd - positionStart;
+
+    return positionStart;
+}
+
+Sci::Position QRegexSearch::contextStart(Document *doc, Sci::Position position)
+{
+    // A subject has to start on a character or it would be decoded differently
+    return doc->MovePositionOutsideChar(position - qMin(position, ContextBytes), -1, false);
+}
+
+bool QRegexSearch::refreshContext(Document *doc)
+{
+    // Any match still points into the view, and writing to it while it is shared would copy all of it
+    match = QRegularExpressionMatch();
+
+    const Sci::Position boundary = viewStaleBefore - viewShift;
+    const qsizetype boundaryIndex = indexOfByte(boundary);
+
+    const Sci::Position start = contextStart(doc, viewStaleBefore);
+    const Sci::Position contextLength = viewStaleBefore - start;
+    const QString context = QString::fromUtf8(doc->RangePointer(start, contextLength), contextLength);
+
+    if (context.size() > boundaryIndex)
+        return false;
+
+    // The text up to the boundary is what the document has now. What comes before it is out of date, so the regex
+    // doesn't get to see it. Only the boundary is known to be the same in both the view and the document after this.
+    std::copy(context.cbegin(), context.cend(), view.begin() + (boundaryIndex - context.size()));
+    subjectStart = boundaryIndex - context.size();
+    anchorIndex = boundaryIndex;
+    anchorByte = boundary;
+    contextIsFresh = true;
+
+    return true;
+}
@@ -20,7 +20,9 @@
 #ifndef QREGEXSEARCH_H
 #define QREGEXSEARCH_H
 
+#include <QRegularExpression>
 #include <QRegularExpressionMatch>
+#include <QString>
 
 #include <vector>
 #include <map>
@@ -85,17 +87,63 @@
 
 using namespace Scintilla::Internal;
 
-class QRegexSearch : public RegexSearchBase
+class QRegexSearch : public RegexSearchBase, public DocWatcher
 {
 public:
     QRegexSearch();
+    ~QRegexSearch() override;
 
     Sci::Position FindText(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s, bool caseSensitive, bool word, bool wordStart, Scintilla::FindOption flags, Sci::Position *length) override;
     const char *SubstituteByPosition(Document *doc, const char *text, Sci::Position *length) override;
 
+    // DocWatcher. Only text changes are of interest, they tell which part of the decoded view is still usable
+    void NotifyModifyAttempt(Document *doc, void *userData) override;
+    void NotifySavePoint(Document *doc, void *userData, bool atSavePoint) override;
+    void NotifyModified(Document *doc, DocModification mh, void *userData) override;
+    void NotifyDeleted(Document *doc, void *userData) noexcept override;
+    void NotifyStyleNeeded(Document *doc, void *userData, Sci::Position endPos) override;
+    void NotifyErrorOccurred(Document *doc, void *userData, Scintilla::Status status) override;
+
 private:
+    static QRegularExpression compiledExpression(const char *pattern, QRegularExpression::PatternOptions options);
+
+    bool viewCovers(Sci::Position start, Sci::Position end) const;
+    void decodeDocument(Document *doc);
+    qsizetype indexOfByte(Sci::Position bytePos) const;
+    Sci::Position byteOfIndex(qsizetype index) const;
+
+    Sci::Position findInView(const QRegularExpression &re, Sci::Position rangeStart, Sci::Position rangeEnd, bool backwards, Sci::Position *length);
+    Sci::Position findInRange(Document *doc, const QRegularExpression &re, Sci::Position subjectStart, Sci::Position rangeStart, Sci::Position rangeEnd, Sci::Position *length);
+
+    static Sci::Position contextStart(Document *doc, Sci::Position position);
+    bool refreshContext(Document *doc);
+
     QRegularExpressionMatch match;
     QByteArray *substituted = Q_NULLPTR;
+
+    // The document is decoded to UTF-16 once and kept for every search after that, rather than decoding
+    // everything past the start position on each call. Edits don't throw it away: positions before the last
+    // edit are no longer in the view, and the ones after it are found again by shifting them by viewShift.
+    Document *watchedDoc = Q_NULLPTR;
+    QString view;
+    bool viewIsValid = false;
+    bool viewIsUtf8 = false;
+    bool viewIsAscii = false;
+    Sci::Position viewLength = 0; // In bytes
+    Sci::Position viewShift = 0; // Document position minus view position
+    Sci::Position viewStaleBefore = 0; // Document positions before this are out of date in the view
+
+    // The text just before viewStaleBefore is decoded again after each edit and written over the view, so that it
+    // is what the regex sees before the start of a search. The view is only searched from subjectStart on, and
+    // offsets are only mapped from the anchor on, since the text before it no longer takes up the same bytes.
+    bool contextIsFresh = true;
+    qsizetype subjectStart = 0;
+    qsizetype anchorIndex = 0;
+    Sci::Position anchorByte = 0;
+
+    // Byte offset of every CheckpointInterval-th UTF-16 index in the view, so offsets can be mapped either
+    // way by walking at most that many characters
+    std::vector<Sci::Position> checkpoints;
 };
 
 #endif // QREGEXSEARCH_H
@@ -19,35 +19,35 @@
 
 #include "ScintillaNext.h"
 #include "ScintillaCommenter.h"
+#include "FileFollower.h"
+#include "FileLoader.h"
+#include "FileReloader.h"
+#include "PagedFileViewer.h"
 
-#include "uchardet.h"
 #include <cinttypes>
+#include <memory>
+#include <vector>
 
+#include <QCoreApplication>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QMouseEvent>
+#include <QMutex>
 #include <QSaveFile>
-#include <QTextCodec>
+#include <QThreadPool>
 
 
-const int CHUNK_SIZE = 1024 * 1024 * 4; // Not sure what is best
+const qint64 BACKGROUND_LOAD_SIZE = 1024 * 1024 * 32; // Anything larger gets loaded on a worker thread
+const qint64 LARGE_FILE_SIZE = 1024 * 1024 * 1024; // Anything larger gets a document without styling
+const qint64 PAGED_FILE_SIZE = LARGE_FILE_SIZE * 4; // Anything larger is never read into a document at all
 
 
-static QFileDevice::FileError writeToDisk(const QByteArray &data, const QString &path)
+// Background saves are written one after another, so saving the same file twice in a row can never get them out of order
+static QThreadPool *savePool()
 {
-    qInfo(Q_FUNC_INFO);
-
-    QFile file(path);
-
-    if (file.open(QIODevice::WriteOnly)) {
-        if (file.write(data) != -1) {
-            file.close();
-            return QFileDevice::NoError;
-        }
-    }
-
-    // If it got to this point there was an error
-    qWarning("writeToDisk() failure code %d: %s", file.error(), qPrintable(file.errorString()));
-    return file.error();
+    static QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    return &pool;
 }
 
 static bool isNewlineCharacter(char c)
@@ -58,19 +58,29 @@ static bool isNewlineCharacter(char c)
 ScintillaNext::ScintillaNext(QString name, QWidget *parent) :
     ScintillaEdit(parent),
     name(name),
-    indicatorResources(INDICATOR_MAX + 1)
+    indicatorResources(INDICATOR_MAX + 1),
+    backgroundWriteMutex(std::make_shared<QMutex>())
 {
     // Per the scintilla documentation, some parts of the range are not generally available
     indicatorResources.disableRange(0, 7);
     indicatorResources.disableRange(INDICATOR_IME, INDICATOR_IME_MAX);
     indicatorResources.disableRange(INDICATOR_HISTORY_REVERTED_TO_ORIGIN_INSERTION, INDICATOR_HISTORY_REVERTED_TO_MODIFIED_DELETION);
+
+    connect(this, &ScintillaNext::modified, this, [=](Scintilla::ModificationFlags type) {
+        if (FlagSet(type, Scintilla::ModificationFlags::InsertText) || FlagSet(type, Scintilla::ModificationFlags::DeleteText)) {
+            generation++;
+        }
+    });
 }
 
 ScintillaNext::~ScintillaNext()
 {
+    if (loader) {
+        loader->cancel();
+    }
 }
 
-ScintillaNext *ScintillaNext::fromFile(const QString &filePath, bool tryToCreate)
+ScintillaNext *ScintillaNext::fromFile(const QString &filePath, bool tryToCreate, QThreadPool *pool)
 {
     QFile file(filePath);
     ScintillaNext *editor = new ScintillaNext(file.fileName());
@@ -85,7 +95,20 @@ ScintillaNext *ScintillaNext::fromFile(const QString &filePath, bool tryToCreate
         f.close();
     }
 
-    bool readSuccessful = editor->readFromDisk(file);
+    bool readSuccessful;
+
+    if (file.size() >= PAGED_FILE_SIZE) {
+        readSuccessful = editor->openPaged(file);
+    }
+    else if (pool) {
+        readSuccessful = editor->readFromDiskInBackground(file, pool);
+    }
+    else if (file.size() >= BACKGROUND_LOAD_SIZE) {
+        readSuccessful = editor->readFromDiskInBackground(file, QThreadPool::globalInstance());
+    }
+    else {
+        readSuccessful = editor->readFromDisk(file);
+    }
 
     if (!readSuccessful) {
         delete editor;
@@ -97,12 +120,150 @@ ScintillaNext *ScintillaNext::fromFile(const QString &filePath, bool tryToCreate
     return editor;
 }
 
+ScintillaNext *ScintillaNext::placeholderForFile(const QString &filePath)
+{
+    ScintillaNext *editor = new ScintillaNext(QFileInfo(filePath).fileName());
+
+    editor->setFileInfo(filePath);
+    editor->placeholder = true;
+
+    // Nothing should be typed into it before the real text is there
+    editor->setReadOnly(true);
+
+    return editor;
+}
+
+bool ScintillaNext::materialize()
+{
+    if (hibernated) {
+        return wakeUp();
+    }
+
+    if (!placeholder) {
+        return true;
+    }
+
+    qInfo("Reading placeholder \"%s\"", qUtf8Printable(fileInfo.filePath()));
+
+    placeholder = false;
+    setReadOnly(false);
+
+    QFile file(fileInfo.filePath());
+
+    if (file.exists()) {
+        updateTimestamp();
+    }
+
+    // Placeholders are made without looking at the file, so this decides the same way fromFile() does
+    if (file.size() >= PAGED_FILE_SIZE) {
+        const bool opened = openPaged(file);
+
+        emit materialized();
+        emit loadFinished(opened);
+
+        if (!opened) {
+            emit loadFailed(tr("Unable to open the file"));
+        }
+
+        return opened;
+    }
+
+    if (file.size() >= BACKGROUND_LOAD_SIZE) {
+        // loadFinished() is emitted once the loader is done with it
+        if (readFromDiskInBackground(file, QThreadPool::globalInstance())) {
+            emit materialized();
+            return true;
+        }
+
+        emit materialized();
+        emit loadFinished(false);
+        emit loadFailed(file.exists() ? file.errorString() : tr("The file does not exist"));
+        return false;
+    }
+
+    const bool readSuccessful = readFromDisk(file);
+
+    emit materialized();
+    emit loadFinished(readSuccessful);
+
+    if (!readSuccessful) {
+        emit loadFailed(file.exists() ? file.errorString() : tr("The file does not exist"));
+    }
+
+    return readSuccessful;
+}
+
+qint64 ScintillaNext::hibernate()
+{
+    // Only clean files are hibernated, anything else could not be read again if need be. The undo history would be
+    // dropped too, so a file that was edited and then saved keeps it.
+    if (isLoading() || isFollowing() || isPaged() || isLargeFile() || !isFile() || !isSavedToDisk() || canUndo()) {
+        return -1;
+    }
+
+    const qint64 textLength = length();
+    const bool hasStyles = !(documentOptions() & SC_DOCUMENTOPTION_STYLES_NONE);
+
+    // Not counting the undo history or the layout cache, which only makes this an underestimate
+    const qint64 residentBytes = textLength * (hasStyles ? 2 : 1) + lineCount() * static_cast<qint64>(sizeof(Sci_Position));
+
+    QByteArray text;
+    text.reserve(textLength);
+    for (const FileWriter::Segment &segment : documentSegments()) {
+        text.append(segment.data, static_cast<int>(segment.length));
+    }
+
+    hibernatedView = EditorViewState::capture(this);
+    hibernatedText = qCompress(text, 1);
+    hibernatedReadOnly = readOnly();
+    hibernated = true;
+
+    attachLoadedDocument(reinterpret_cast<void *>(createDocument(0, documentOptions())));
+
+    // Don't let anything get typed into the empty document
+    setReadOnly(true);
+
+    return residentBytes - hibernatedText.size();
+}
+
+bool ScintillaNext::wakeUp()
+{
+    const QByteArray text = qUncompress(hibernatedText);
+
+    hibernated = false;
+    hibernatedText.clear();
+
+    auto iloader = reinterpret_cast<Scintilla::ILoader *>(createLoader(text.size(), documentOptions()));
+
+    if (iloader == Q_NULLPTR || iloader->AddData(text.constData(), text.size()) != SC_STATUS_OK) {
+        qWarning("Unable to restore hibernated text of \"%s\", reading it again", qUtf8Printable(getName()));
+
+        if (iloader) {
+            iloader->Release();
+        }
+
+        placeholder = true;
+        return materialize();
+    }
+
+    attachLoadedDocument(iloader->ConvertToDocument());
+    setReadOnly(hibernatedReadOnly);
+
+    // The new document has no lexer, which needs to be set up before the folds can be put back
+    emit awakened();
+
+    hibernatedView.apply(this);
+    hibernatedView = EditorViewState();
+
+    return true;
+}
+
 int ScintillaNext::allocateIndicator(const QString &name)
 {
     return indicatorResources.requestResource(name);
 }
 
-void ScintillaNext::goToRange(const Sci_CharacterRange &range)
+void ScintillaNext::goToRange(const Sci_CharacterRangeFull &range)
 {
     qInfo(Q_FUNC_INFO);
 
@@ -155,8 +316,8 @@ void ScintillaNext::deleteLeadingEmptyLines()
 
 void ScintillaNext::deleteTrailingEmptyLines()
 {
-    const int docLength = length();
-    int position = docLength;
+    const Sci_Position docLength = length();
+    Sci_Position position = docLength;
 
     while (position > 0 && isNewlineCharacter(charAt(position - 1))) {
         position--;
@@ -176,6 +337,11 @@ bool ScintillaNext::canSaveToDisk() const
     // - It is marked as a temporary since as soon as it gets saved it is no longer a temporary buffer
     // - A modified file
     // - A missing file since as soon as it is saved it is no longer missing.
+    // The buffer can never be saved while it is still being loaded since it is incomplete.
+    if (isLoading()) {
+        return false;
+    }
+
     return temporary ||
            (bufferType == ScintillaNext::New && modify()) ||
            (bufferType == ScintillaNext::File && modify()) ||
@@ -239,6 +405,15 @@ void ScintillaNext::setFoldMarkers(const QString &type)
 
 void ScintillaNext::close()
 {
+    // Stop any background load now rather than waiting for the editor to be deleted
+    if (loader) {
+        loader->cancel();
+    }
+
+    if (reloader) {
+        reloader->cancel();
+    }
+
     emit closed();
 
     deleteLater();
@@ -250,9 +425,16 @@ QFileDevice::FileError ScintillaNext::save()
 
     Q_ASSERT(isFile());
 
+    if (isLoading() || isPaged()) {
+        return QFileDevice::WriteError;
+    }
+
+    // Anything still waiting to be written in the background is older than this
+    cancelBackgroundSaves();
+
     emit aboutToSave();
 
-    QFileDevice::FileError writeSuccessful = writeToDisk(QByteArray::fromRawData((char*)characterPointer(), textLength()), fileInfo.filePath());
+    QFileDevice::FileError writeSuccessful = writeToDisk(fileInfo.filePath());
 
     if (writeSuccessful == QFileDevice::NoError) {
         updateTimestamp();
@@ -267,6 +449,106 @@ QFileDevice::FileError ScintillaNext::save()
     return writeSuccessful;
 }
 
+void ScintillaNext::saveInBackground()
+{
+    qInfo(Q_FUNC_INFO);
+
+    Q_ASSERT(isFile());
+
+    if (isLoading() || isPaged()) {
+        emit backgroundSaveFinished(QFileDevice::WriteError);
+        return;
+    }
+
+    emit aboutToSave();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // The text can keep changing while it is written out, so take a copy of it as it is right now. The gap
+    // buffer's pieces get copied as they are rather than moving the gap around.
+    auto snapshot = std::make_shared<std::vector<char>>();
+    snapshot->reserve(static_cast<size_t>(length()));
+
+    for (const FileWriter::Segment &segment : documentSegments()) {
+        snapshot->insert(snapshot->end(), segment.data, segment.data + segment.length);
+    }
+
+    qInfo("Copied %zu bytes to save in the background in %lld ms", snapshot->size(), timer.elapsed());
+
+    // A save of older text that has not been written yet doesn't need to be
+    if (backgroundSaveCancelled) {
+        *backgroundSaveCancelled = true;
+    }
+
+    const auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    const std::shared_ptr<QMutex> mutex = backgroundWriteMutex;
+    FileWriter writer = createWriter(fileInfo.filePath());
+    const quint64 savedGeneration = generation;
+    const QPointer<ScintillaNext> self(this);
+
+    writer.setCancelFlag(cancelled.get());
+    backgroundSaveCancelled = cancelled;
+    backgroundSaves++;
+
+    savePool()->start([=]() {
+        QFileDevice::FileError error = QFileDevice::AbortError;
+
+        {
+            QMutexLocker locker(mutex.get());
+
+            if (!*cancelled) {
+                FileWriter backgroundWriter = writer;
+                error = backgroundWriter.write({{snapshot->data(), static_cast<qint64>(snapshot->size())}});
+            }
+        }
+
+        // The editor may be gone by the time this is done
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [=]() {
+            if (self) {
+                self->finishBackgroundSave(error, savedGeneration);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ScintillaNext::cancelBackgroundSaves()
+{
+    if (backgroundSaveCancelled) {
+        *backgroundSaveCancelled = true;
+        backgroundSaveCancelled.reset();
+    }
+
+    // One may be partway through writing the file, it stops at the next chunk. Anything queued behind it sees
+    // it was cancelled and never touches the file, so there is no need to wait for the whole pool.
+    QMutexLocker locker(backgroundWriteMutex.get());
+}
+
+void ScintillaNext::finishBackgroundSave(QFileDevice::FileError error, quint64 savedGeneration)
+{
+    backgroundSaves--;
+
+    // A later save took over, it reports for itself
+    if (error == QFileDevice::AbortError) {
+        return;
+    }
+
+    if (error == QFileDevice::NoError) {
+        updateTimestamp();
+
+        // Anything typed while it was being written has not been saved yet, so it is only a save point if nothing was
+        if (generation == savedGeneration) {
+            setSavePoint();
+        }
+
+        setTemporary(false);
+
+        emit saved();
+    }
+
+    emit backgroundSaveFinished(error);
+}
+
 void ScintillaNext::reload()
 {
     Q_ASSERT(isFile());
@@ -276,6 +558,118 @@ void ScintillaNext::reload()
         return;
     }
 
+    // The file may be half written, and it is this editor's text anyway
+    if (backgroundSaves > 0) {
+        return;
+    }
+
+    // Only the window and the index need to be read again
+    if (isPaged()) {
+        pager->refresh();
+        return;
+    }
+
+    // The compressed copy is out of date now, the reload below takes care of the difference
+    if (hibernated) {
+        wakeUp();
+    }
+
+    // The load that is still in progress will already pick up the latest contents
+    if (isLoading()) {
+        return;
+    }
+
+    // The follower already keeps the text up to date with the file
+    if (isFollowing()) {
+        return;
+    }
+
+    // Whatever the previous reload read may already be out of date
+    if (reloader) {
+        reloader->cancel();
+    }
+
+    // Comparing the lines needs a copy of the whole file in memory, which is not worth it for these
+    if (isLargeFile() || QFileInfo(fileInfo.canonicalFilePath()).size() >= LARGE_FILE_SIZE) {
+        reloadFromScratch();
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    FileReloader *fileReloader = new FileReloader(fileInfo.canonicalFilePath(), FileReloader::hashLines(documentSegments()));
+    reloader = fileReloader;
+
+    qInfo("Hashed the lines of \"%s\" in %lld ms", qUtf8Printable(getName()), timer.elapsed());
+
+    // Any edit made in the meantime would throw off the positions the changes are worked out for. The file will
+    // still be newer than the document so it will get reloaded again the next time it is checked.
+    connect(this, &ScintillaNext::modified, fileReloader, [=](Scintilla::ModificationFlags type) {
+        if (FlagSet(type, Scintilla::ModificationFlags::InsertText) || FlagSet(type, Scintilla::ModificationFlags::DeleteText)) {
+            fileReloader->cancel();
+        }
+    });
+
+    const quint64 queuedGeneration = generation;
+
+    connect(fileReloader, &FileReloader::finished, this, [=](bool success) {
+        if (reloader == fileReloader) {
+            reloader.clear();
+        }
+
+        if (!success || fileReloader->isCancelled()) {
+            return;
+        }
+
+        // The changes were worked out against the text as it was when this was queued. If anything touched it
+        // since (e.g. a follower that started in the meantime and already appended the new text) they no longer apply.
+        if (isFollowing() || generation != queuedGeneration) {
+            qInfo("Dropping out of date reload of \"%s\"", qUtf8Printable(getName()));
+            return;
+        }
+
+        // These edits are the reload itself, not something to cancel it for
+        disconnect(this, &ScintillaNext::modified, fileReloader, Q_NULLPTR);
+
+        applyReload(fileReloader);
+    });
+
+    fileReloader->start();
+}
+
+void ScintillaNext::applyReload(const FileReloader *fileReloader)
+{
+    const QByteArray &text = fileReloader->getText();
+    const bool wasReadOnly = readOnly();
+
+    setReadOnly(false);
+
+    // Going from the end keeps the positions of the earlier edits valid. All of it can be undone in one go.
+    beginUndoAction();
+    for (auto edit = fileReloader->getEdits().crbegin(); edit != fileReloader->getEdits().crend(); ++edit) {
+        setTargetRange(edit->oldStart, edit->oldEnd);
+        replaceTargetMinimal(edit->newEnd - edit->newStart, text.constData() + edit->newStart);
+    }
+    endUndoAction();
+
+    setReadOnly(wasReadOnly);
+
+    codec = fileReloader->getAnalyzer().codec();
+    bom = fileReloader->getAnalyzer().hasBom();
+    applyAnalysis(fileReloader->getAnalyzer());
+
+    updateTimestamp();
+    setSavePoint();
+
+    qInfo("Reloaded \"%s\" by applying %d change(s)", qUtf8Printable(getName()), static_cast<int>(fileReloader->getEdits().size()));
+}
+
+void ScintillaNext::reloadFromScratch()
+{
+    // The text can't be replaced otherwise, readFromDisk() decides again whether it should be read-only
+    setReadOnly(false);
+
     // Remove all the text
     {
         const QSignalBlocker blocker(this);
@@ -294,17 +688,25 @@ void ScintillaNext::reload()
         updateTimestamp();
         setSavePoint();
     }
-
-    return;
 }
 
 QFileDevice::FileError ScintillaNext::saveAs(const QString &newFilePath)
 {
+    // Only part of a paged file is in the document
+    if (isLoading() || isPaged()) {
+        return QFileDevice::WriteError;
+    }
+
     bool isRenamed = bufferType == ScintillaNext::New || fileInfo.canonicalFilePath() != newFilePath;
 
+    // Saves in the background write to the current file, so only get in the way if it is the same one
+    if (!isRenamed) {
+        cancelBackgroundSaves();
+    }
+
     emit aboutToSave();
 
-    QFileDevice::FileError saveSuccessful = writeToDisk(QByteArray::fromRawData((char*)characterPointer(), textLength()), newFilePath);
+    QFileDevice::FileError saveSuccessful = writeToDisk(newFilePath);
 
     if (saveSuccessful == QFileDevice::NoError) {
         setFileInfo(newFilePath);
@@ -325,7 +727,131 @@ QFileDevice::FileError ScintillaNext::saveAs(const QString &newFilePath)
 
 QFileDevice::FileError ScintillaNext::saveCopyAs(const QString &filePath)
 {
-    return writeToDisk(QByteArray::fromRawData((char*)characterPointer(), textLength()), filePath);
+    if (isLoading() || isPaged()) {
+        return QFileDevice::WriteError;
+    }
+
+    return writeToDisk(filePath);
+}
+
+QFileDevice::FileError ScintillaNext::saveRawCopyAs(const QString &filePath) const
+{
+    if (isLoading() || isPaged()) {
+        return QFileDevice::WriteError;
+    }
+
+    // Converting it would lose anything the codec can't represent, and anything reading it back expects UTF-8
+    FileWriter writer = createWriter(filePath);
+    writer.setEncoding(Q_NULLPTR, false);
+
+    return writer.write(documentSegments());
+}
+
+QVector<FileWriter::Segment> ScintillaNext::documentSegments() const
+{
+    // The text is stored in a gap buffer. Asking for each side of the gap separately leaves the gap
+    // where it is, whereas characterPointer() would first move it to the end of the buffer.
+    const Sci_Position gap = gapPosition();
+    const Sci_Position docLength = length();
+    QVector<FileWriter::Segment> segments;
+
+    if (gap > 0) {
+        segments.append({reinterpret_cast<const char *>(rangePointer(0, gap)), gap});
+    }
+
+    if (docLength > gap) {
+        segments.append({reinterpret_cast<const char *>(rangePointer(gap, docLength - gap)), docLength - gap});
+    }
+
+    return segments;
+}
+
+ScintillaNext::TextSnapshot ScintillaNext::textSnapshot() const
+{
+    if (hibernated) {
+        const QByteArray compressedText = hibernatedText;
+
+        return [=]() {
+            const QByteArray text = qUncompress(compressedText);
+
+            return std::make_shared<const std::vector<char>>(text.constBegin(), text.constEnd());
+        };
+    }
+
+    // Too big to ever be in one piece, only a window of it is in the document
+    if (isPaged()) {
+        return []() { return std::shared_ptr<const std::vector<char>>(); };
+    }
+
+    // Text that isn't in the document yet is read from the file instead. Anything that is in the document is copied
+    // from it, even if it was saved, since the file can be changed by something else without the editor knowing yet.
+    if ((placeholder || !loader.isNull()) && isFile()) {
+        const QString filePath = fileInfo.filePath();
+
+        return [=]() {
+            QFile file(filePath);
+
+            // It would be opened paged, so it can't be searched either
+            if (!file.open(QIODevice::ReadOnly) || file.size() >= PAGED_FILE_SIZE) {
+                return std::shared_ptr<const std::vector<char>>();
+            }
+
+            auto text = std::make_shared<std::vector<char>>();
+            text->reserve(static_cast<size_t>(file.size()));
+
+            // Read the same way the loader does, so positions in it line up with the document
+            FileLoader::readFile(file, [&](const char *data, qint64 length) {
+                text->insert(text->end(), data, data + length);
+                return true;
+            });
+
+            return std::shared_ptr<const std::vector<char>>(text);
+        };
+    }
+
+    // The gap buffer's pieces get copied as they are, the same as saveInBackground()
+    auto text = std::make_shared<std::vector<char>>();
+    text->reserve(static_cast<size_t>(length()));
+
+    for (const FileWriter::Segment &segment : documentSegments()) {
+        text->insert(text->end(), segment.data, segment.data + segment.length);
+    }
+
+    const std::shared_ptr<const std::vector<char>> snapshot = text;
+
+    return [=]() { return snapshot; };
+}
+
+void ScintillaNext::setEncoding(QTextCodec *codec, bool bom)
+{
+    this->codec = codec;
+    this->bom = bom;
+}
+
+void ScintillaNext::setAtomicSave(bool atomic)
+{
+    atomicSave = atomic;
+}
+
+void ScintillaNext::setSaveSyncMode(FileWriter::SyncMode mode)
+{
+    saveSyncMode = mode;
+}
+
+QFileDevice::FileError ScintillaNext::writeToDisk(const QString &path) const
+{
+    return createWriter(path).write(documentSegments());
+}
+
+FileWriter ScintillaNext::createWriter(const QString &path) const
+{
+    FileWriter writer(path);
+
+    writer.setAtomic(atomicSave);
+    writer.setSyncMode(saveSyncMode);
+    writer.setEncoding(codec, bom);
+
+    return writer;
 }
 
 bool ScintillaNext::rename(const QString &newFilePath)
@@ -333,7 +859,7 @@ bool ScintillaNext::rename(const QString &newFilePath)
     emit aboutToSave();
 
     // Write out the buffer to the new path
-    if (saveCopyAs(newFilePath)) {
+    if (saveCopyAs(newFilePath) == QFileDevice::NoError) {
         // Remove the old file
         const QString oldPath = fileInfo.canonicalFilePath();
         QFile::remove(oldPath);
@@ -355,16 +881,103 @@ bool ScintillaNext::rename(const QString &newFilePath)
     return false;
 }
 
+bool ScintillaNext::setFollowing(bool follow)
+{
+    if (follow == isFollowing()) {
+        return true;
+    }
+
+    if (!follow) {
+        delete follower;
+
+        setReadOnly(binary || !QFileInfo(fileInfo.filePath()).isWritable());
+
+        emit followingChanged(false);
+
+        return true;
+    }
+
+    // Appending to the end of the text only makes sense if the text matches what is on disk
+    if (!isFile() || isLoading() || isPaged() || modify()) {
+        return false;
+    }
+
+    // A reload that is still going would insert text the follower is about to append as well
+    if (reloader) {
+        reloader->cancel();
+    }
+
+    // The follower starts from the end of the file, so the text has to be caught up with it right now
+    if (modifiedTime != fileTimestamp()) {
+        reloadFromScratch();
+    }
+
+    // NOTE: anything written between reading the file and here gets skipped
+    follower = new FileFollower(fileInfo.filePath(), QFileInfo(fileInfo.filePath()).size(), codec, this);
+
+    connect(follower, &FileFollower::appended, this, [=](const QByteArray &data) {
+        // Only keep scrolling if the caret is already at the end, otherwise the user is looking at something
+        const bool atEnd = currentPos() == length() && selectionEmpty();
+
+        setReadOnly(false);
+        setUndoCollection(false);
+        appendText(data.size(), data.constData());
+        setUndoCollection(true);
+        setReadOnly(true);
+
+        setSavePoint();
+        updateTimestamp();
+
+        if (atEnd) {
+            gotoPos(length());
+        }
+    });
+
+    connect(follower, &FileFollower::restarted, this, [=]() {
+        setReadOnly(false);
+        setUndoCollection(false);
+        clearAll();
+        emptyUndoBuffer();
+        setUndoCollection(true);
+        setReadOnly(true);
+    });
+
+    // The follower is tied to the path it was given
+    connect(this, &ScintillaNext::renamed, follower, [=]() { setFollowing(false); });
+
+    // Nothing can be typed into the text while it is being followed
+    setReadOnly(true);
+
+    emit followingChanged(true);
+
+    return true;
+}
+
 ScintillaNext::FileStateChange ScintillaNext::checkFileForStateChange()
 {
     if (bufferType == BufferType::New) {
         return FileStateChange::NoChange;
     }
-    else if (bufferType == BufferType::File) {
-        // refresh else exists() fails to notice missing file
-        fileInfo.refresh();
 
-        if (!fileInfo.exists()) {
+    // refresh else exists() fails to notice missing file
+    fileInfo.refresh();
+
+    return updateFileState(fileInfo.exists(), fileInfo.lastModified());
+}
+
+ScintillaNext::FileStateChange ScintillaNext::updateFileState(bool exists, const QDateTime &lastModified)
+{
+    if (bufferType == BufferType::New) {
+        return FileStateChange::NoChange;
+    }
+
+    // The change is most likely a background save writing it, finishBackgroundSave() catches the timestamp up
+    if (backgroundSaves > 0) {
+        return FileStateChange::NoChange;
+    }
+
+    if (bufferType == BufferType::File) {
+        if (!exists) {
             bufferType = BufferType::FileMissing;
 
             emit savePointChanged(false);
@@ -373,7 +986,7 @@ ScintillaNext::FileStateChange ScintillaNext::checkFileForStateChange()
         }
 
         // See if the timestamp changed
-        if (modifiedTime != fileTimestamp()) {
+        if (modifiedTime != lastModified) {
             return FileStateChange::Modified;
         }
         else {
@@ -382,9 +995,8 @@ ScintillaNext::FileStateChange ScintillaNext::checkFileForStateChange()
     }
     else if (bufferType == BufferType::FileMissing) {
         // See if it reappeared
-        fileInfo.refresh();
-
-        if (fileInfo.exists()) {
+        if (exists) {
+            fileInfo.refresh();
             bufferType = BufferType::File;
 
             return FileStateChange::Restored;
@@ -470,66 +1082,22 @@ bool ScintillaNext::readFromDisk(QFile &file)
     // TODO disable notifications
     // modEventMask(SC_MOD_NONE)?
 
-    QByteArray chunk;
-    qint64 bytesRead;
-    QTextCodec *codec = Q_NULLPTR;
-    QTextCodec::ConverterState state;
-
-    bool first_read = true;
-    do {
-        // Try to read as much as possible
-        chunk.resize(CHUNK_SIZE);
-        bytesRead = file.read(chunk.data(), CHUNK_SIZE);
-        chunk.resize(bytesRead);
-
-        qDebug("Read %lld bytes", bytesRead);
-
-        // TODO: this needs moved out of here. Would make much more sense to have a class (or classes)
-        // responsible for handling low level situations like this to do things like:
-        // - determine encoding
-        // - determine space vs tabs
-        // - determine indentation size
-
-        if (first_read) {
-            first_read = false;
-
-            // Search for a BOM mark
-            codec = QTextCodec::codecForUtfText(chunk, Q_NULLPTR);
-
-            if (codec != Q_NULLPTR) {
-                qDebug("BOM mark found");
-            }
-            else {
-                qDebug("BOM mark not found, using uchardet");
-
-                // Limit decoding to the first 64 kilobytes
-                int detectionSize = qMin(chunk.size(), 64 * 1024);
-
-                // Use uchardet to try and detect file encoding since no BOM was found
-                uchardet_t encodingDetector = uchardet_new();
-                if (uchardet_handle_data(encodingDetector, chunk.data(), detectionSize) == 0) {
-                    uchardet_data_end(encodingDetector);
-
-                    qDebug("uchardet detected encoding as: '%s'", uchardet_get_charset(encodingDetector));
-                    codec = QTextCodec::codecForName(uchardet_get_charset(encodingDetector));
-                }
-                else {
-                    qDebug("uchardet failure");
-                }
-                uchardet_delete(encodingDetector);
-            }
+    FileAnalyzer analyzer;
+    bool linesAllocated = false;
+    const bool readSuccessful = FileLoader::readFile(file, [&](const char *data, qint64 length) {
+        appendText(length, data);
 
-            qDebug("Using codec: '%s'", codec ? codec->name().constData() : "");
+        // The first chunk gives a good enough idea of the line length to size the line index up front
+        if (!linesAllocated) {
+            allocateLines(analyzer.estimateLineCount(file.size()));
+            linesAllocated = true;
         }
 
-        if (codec) {
-            const QByteArray utf8_data = codec->toUnicode(chunk.constData(), chunk.size(), &state).toUtf8();
-            appendText(utf8_data.size(), utf8_data.constData());
-        }
-        else {
-            appendText(chunk.size(), chunk.constData());
-        }
-    } while (!file.atEnd() && status() == SC_STATUS_OK);
+        return status() == SC_STATUS_OK;
+    }, &analyzer);
+
+    codec = analyzer.codec();
+    bom = analyzer.hasBom();
 
     file.close();
 
@@ -543,11 +1111,12 @@ bool ScintillaNext::readFromDisk(QFile &file)
         return false;
     }
 
-    if (bytesRead == -1) {
-        qWarning("Something bad happened when reading disk %d %s", file.error(), qUtf8Printable(file.errorString()));
+    if (!readSuccessful) {
         return false;
     }
 
+    applyAnalysis(analyzer);
+
     if (!QFileInfo(file).isWritable()) {
         qInfo("Setting file as read-only");
         setReadOnly(true);
@@ -556,6 +1125,147 @@ bool ScintillaNext::readFromDisk(QFile &file)
     return true;
 }
 
+bool ScintillaNext::openPaged(QFile &file)
+{
+    qInfo("\"%s\" is too big to read, viewing it a window at a time", qUtf8Printable(file.fileName()));
+
+    PagedFileViewer *viewer = new PagedFileViewer(this, file.fileName());
+
+    if (!viewer->open()) {
+        delete viewer;
+        return false;
+    }
+
+    pager = viewer;
+
+    return true;
+}
+
+bool ScintillaNext::readFromDiskInBackground(QFile &file, QThreadPool *pool)
+{
+    if (!file.exists()) {
+        qWarning("Cannot read \"%s\": doesn't exist", qUtf8Printable(file.fileName()));
+        return false;
+    }
+
+    // Positions past 2GB need 64-bit line indices, and styling that much text is not worth the memory or the time
+    const bool largeFile = file.size() >= LARGE_FILE_SIZE;
+    const int documentOptions = largeFile ? SC_DOCUMENTOPTION_TEXT_LARGE | SC_DOCUMENTOPTION_STYLES_NONE : SC_DOCUMENTOPTION_DEFAULT;
+
+    // The loader document lives independently of this editor until it is attached
+    auto iloader = reinterpret_cast<Scintilla::ILoader *>(createLoader(file.size(), documentOptions));
+
+    if (iloader == Q_NULLPTR) {
+        qWarning("SCI_CREATELOADER failed for \"%s\"", qUtf8Printable(file.fileName()));
+        return false;
+    }
+
+    qInfo("Loading \"%s\" in the background%s", qUtf8Printable(file.fileName()), largeFile ? " in large file mode" : "");
+
+    // Don't let anything get typed into the placeholder document
+    setReadOnly(true);
+
+    FileLoader *fileLoader = new FileLoader(file.fileName(), iloader);
+    loader = fileLoader;
+
+    connect(fileLoader, &FileLoader::progress, this, [=](qint64 bytesRead, qint64 totalBytes) {
+        emit loadProgress(totalBytes > 0 ? static_cast<int>(bytesRead * 100 / totalBytes) : 100);
+    });
+
+    connect(fileLoader, &FileLoader::finished, this, [=](bool success) {
+        loader.clear();
+
+        if (success && !fileLoader->isCancelled()) {
+            attachLoadedDocument(fileLoader->takeDocument());
+
+            codec = fileLoader->getAnalyzer().codec();
+            bom = fileLoader->getAnalyzer().hasBom();
+            applyAnalysis(fileLoader->getAnalyzer());
+
+            if (!QFileInfo(fileLoader->getFilePath()).isWritable()) {
+                qInfo("Setting file as read-only");
+                setReadOnly(true);
+            }
+        }
+        else {
+            qWarning("Failed to load \"%s\"", qUtf8Printable(fileLoader->getFilePath()));
+        }
+
+        emit loadFinished(success);
+
+        if (!success && !fileLoader->isCancelled()) {
+            emit loadFailed(fileLoader->errorString());
+        }
+    });
+
+    fileLoader->start(pool);
+
+    return true;
+}
+
+void ScintillaNext::applyAnalysis(const FileAnalyzer &analyzer)
+{
+    // Anything set by the analyzer itself is fair game on a reload, but not what was set by others (e.g. EditorConfig)
+    auto isSkipped = [this](const char *name) {
+        const QVariant value = QObject::property(name);
+        return value.isValid() && value.toString() != QStringLiteral("FileAnalyzer");
+    };
+
+    qInfo("Analyzed \"%s\": %lld lines, EOL mode %d, indentation %s (size %d), %s",
+          qUtf8Printable(getName()), analyzer.lineCount(), analyzer.eolMode(),
+          analyzer.hasIndentation() ? (analyzer.usesTabs() ? "tabs" : "spaces") : "unknown", analyzer.indentSize(),
+          analyzer.isBinary() ? "looks binary" : "looks like text");
+
+    invalidUtf8Offset = analyzer.firstInvalidUtf8Offset();
+
+    // Typing into a binary file is almost never what was meant, and saving it would likely break it
+    binary = analyzer.isBinary();
+    if (binary && !readOnly()) {
+        qWarning("\"%s\" looks like a binary file, making it read-only", qUtf8Printable(getName()));
+        setReadOnly(true);
+    }
+
+    if (analyzer.eolMode() != -1 && !isSkipped("nn_skip_eolmode")) {
+        setEOLMode(analyzer.eolMode());
+        QObject::setProperty("nn_skip_eolmode", "FileAnalyzer");
+    }
+
+    if (analyzer.hasIndentation() && !isSkipped("nn_skip_usetabs")) {
+        setUseTabs(analyzer.usesTabs());
+
+        // Set a flag so that the tab/spaces won't get overridden by the language
+        QObject::setProperty("nn_skip_usetabs", "FileAnalyzer");
+
+        if (!analyzer.usesTabs() && analyzer.indentSize() > 0 && !isSkipped("nn_skip_indent")) {
+            setIndent(analyzer.indentSize());
+            QObject::setProperty("nn_skip_indent", "FileAnalyzer");
+        }
+    }
+}
+
+void ScintillaNext::attachLoadedDocument(void *document)
+{
+    // These are all stored in the document rather than the view, so carry them over from the placeholder
+    const int eolMode = eOLMode();
+    const bool tabs = useTabs();
+    const int tabSize = tabWidth();
+    const int indentSize = indent();
+    const bool unindents = backSpaceUnIndents();
+
+    setDocPointer(reinterpret_cast<sptr_t>(document));
+    generation++;
+
+    // The editor now holds a reference to the document so the one from the loader can be dropped
+    releaseDocument(reinterpret_cast<sptr_t>(document));
+
+    setUndoCollection(true);
+    setEOLMode(eolMode);
+    setUseTabs(tabs);
+    setTabWidth(tabSize);
+    setIndent(indentSize);
+    setBackSpaceUnIndents(unindents);
+}
+
 QDateTime ScintillaNext::fileTimestamp()
 {
     Q_ASSERT(bufferType != ScintillaNext::New);
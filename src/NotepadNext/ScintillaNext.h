@@ -20,12 +20,31 @@
 #ifndef SCINTILLANEXT_H
 #define SCINTILLANEXT_H
 
+#include "EditorViewState.h"
+#include "FileWriter.h"
 #include "RangeAllocator.h"
 #include "ScintillaEdit.h"
 
+
+class FileAnalyzer;
+class FileFollower;
+class FileLoader;
+class FileReloader;
+class PagedFileViewer;
+class QMutex;
+class QTextCodec;
+class QThreadPool;
+
 #include <QDateTime>
 #include <QFile>
 #include <QFileInfo>
+#include <QPointer>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
 
 
 
@@ -35,7 +54,7 @@ class ScintillaNext : public ScintillaEdit
     Q_OBJECT
 
 public:
-    static bool isRangeValid(const Sci_CharacterRange &range)
+    static bool isRangeValid(const Sci_CharacterRangeFull &range)
     {
         return range.cpMin != INVALID_POSITION && range.cpMax != INVALID_POSITION;
     }
@@ -43,7 +62,11 @@ public:
     explicit ScintillaNext(QString name, QWidget *parent = Q_NULLPTR);
     virtual ~ScintillaNext();
 
-    static ScintillaNext *fromFile(const QString &filePath, bool tryToCreate=false);
+    // Files are read on the given pool if there is one, otherwise only large files are read in the background
+    static ScintillaNext *fromFile(const QString &filePath, bool tryToCreate=false, QThreadPool *pool=Q_NULLPTR);
+
+    // An editor for the file that does not read it until materialize() is called, e.g. when its tab is first shown
+    static ScintillaNext *placeholderForFile(const QString &filePath);
 
     int allocateIndicator(const QString &name);
 
@@ -51,15 +74,15 @@ public:
     void forEachMatch(const QString &text, Func callback) { forEachMatch(text.toUtf8(), callback); }
 
     template<typename Func>
-    void forEachMatch(const QByteArray &byteArray, Func callback) { forEachMatchInRange(byteArray, callback, {0, (Sci_PositionCR)length()}); }
+    void forEachMatch(const QByteArray &byteArray, Func callback) { forEachMatchInRange(byteArray, callback, {0, length()}); }
 
     template<typename Func>
-    void forEachMatchInRange(const QByteArray &byteArray, Func callback, Sci_CharacterRange range);
+    void forEachMatchInRange(const QByteArray &byteArray, Func callback, Sci_CharacterRangeFull range);
 
     template<typename Func>
     void forEachLineInSelection(int selection, Func callback);
 
-    void goToRange(const Sci_CharacterRange &range);
+    void goToRange(const Sci_CharacterRangeFull &range);
 
     QByteArray eolString() const;
 
@@ -101,6 +124,51 @@ public:
         FileMissing, // Buffer with a missing file on the file system
     };
 
+    // The pieces of the document's text, only valid until the document is modified
+    QVector<FileWriter::Segment> documentSegments() const;
+
+    // Gives a copy of the text as it was when textSnapshot() was called, and can be called from any thread.
+    // Text in the document is copied up front. Hibernated text is only uncompressed, and text that isn't loaded yet
+    // is only read from the file, once it is called. Gives nullptr if the text is too big to have in one piece.
+    using TextSnapshot = std::function<std::shared_ptr<const std::vector<char>>()>;
+    TextSnapshot textSnapshot() const;
+
+    // Goes up every time the text changes, so copies of the text (e.g. in the session) can tell if they are out of date
+    quint64 modificationGeneration() const { return generation; }
+
+    // Loading covers placeholders and hibernated editors too since their text is just as incomplete
+    bool isLoading() const { return placeholder || hibernated || !loader.isNull(); }
+    bool isPlaceholder() const { return placeholder; }
+    bool materialize();
+
+    // Hibernating keeps only a compressed copy of the text and releases the document, materialize() brings it back.
+    // Returns roughly how many bytes were freed, or -1 if the editor can't be hibernated right now.
+    qint64 hibernate();
+    bool isHibernated() const { return hibernated; }
+    const EditorViewState &hibernatedViewState() const { return hibernatedView; }
+
+    // Following keeps appending whatever gets written to the end of the file, like tail -f
+    bool isFollowing() const { return !follower.isNull(); }
+
+    // Files too big to read are shown a window at a time, read-only
+    bool isPaged() const { return !pager.isNull(); }
+    PagedFileViewer *getPager() const { return pager; }
+
+    // Large files use a document with 64-bit line indices and no style storage
+    bool isLargeFile() const { return documentOptions() & SC_DOCUMENTOPTION_TEXT_LARGE; }
+
+    // The encoding the file was in on disk, which it is converted back to when saved
+    QTextCodec *getCodec() const { return codec; }
+    bool hasBom() const { return bom; }
+    // For text that did not come from the file itself, e.g. a copy of it in the session directory
+    void setEncoding(QTextCodec *codec, bool bom);
+    qint64 firstInvalidUtf8Offset() const { return invalidUtf8Offset; }
+    // Lots of NUL bytes, so it is opened read-only. Making it writable again is up to the user.
+    bool isBinary() const { return binary; }
+
+    bool isAtomicSave() const { return atomicSave; }
+    FileWriter::SyncMode getSaveSyncMode() const { return saveSyncMode; }
+
     bool isTemporary() const { return temporary; }
     void setTemporary(bool temp);
 
@@ -115,11 +183,19 @@ public:
 public slots:
     void close();
     QFileDevice::FileError save();
+    // Writes a copy of the text on a worker thread so the editor can keep being used, see backgroundSaveFinished()
+    void saveInBackground();
     void reload();
     QFileDevice::FileError saveAs(const QString &newFilePath);
     QFileDevice::FileError saveCopyAs(const QString &filePath);
+    // Writes the text as UTF-8 exactly as the document holds it, for copies that only get read back by the app itself
+    QFileDevice::FileError saveRawCopyAs(const QString &filePath) const;
+    void setAtomicSave(bool atomic);
+    void setSaveSyncMode(FileWriter::SyncMode mode);
+    bool setFollowing(bool follow);
     bool rename(const QString &newFilePath);
     ScintillaNext::FileStateChange checkFileForStateChange();
+    ScintillaNext::FileStateChange updateFileState(bool exists, const QDateTime &lastModified);
     bool moveToTrash();
 
     void toggleCommentSelection();
@@ -129,9 +205,20 @@ public slots:
 signals:
     void aboutToSave();
     void saved();
+    void backgroundSaveFinished(QFileDevice::FileError error);
     void closed();
     void renamed();
 
+    void loadProgress(int percent);
+    void loadFinished(bool success);
+    // Only for loads that went wrong, not ones cancelled by closing the editor. Emitted after loadFinished().
+    void loadFailed(const QString &reason);
+    void awakened();
+    // A placeholder has started reading its file, so anything held back until then (e.g. the decorators) can be set
+    // up. Emitted before loadFinished().
+    void materialized();
+    void followingChanged(bool following);
+
     void lexerChanged();
 
 protected:
@@ -144,10 +231,40 @@ private:
     QFileInfo fileInfo;
     QDateTime modifiedTime;
     RangeAllocator indicatorResources;
+    QPointer<FileLoader> loader;
+    QPointer<FileFollower> follower;
+    QPointer<FileReloader> reloader;
+    QPointer<PagedFileViewer> pager;
 
     bool temporary = false; // Temporary file loaded from a session. It can either be a 'New' file or actual 'File'
+    bool placeholder = false;
+    bool hibernated = false;
+    QByteArray hibernatedText; // Compressed
+    bool hibernatedReadOnly = false;
+    EditorViewState hibernatedView;
+    quint64 generation = 0;
+    QTextCodec *codec = Q_NULLPTR; // Null when the file is UTF-8 (or just ASCII)
+    bool bom = false;
+    qint64 invalidUtf8Offset = -1; // Where the file stopped being valid UTF-8, if it ever did
+    bool binary = false;
+    bool atomicSave = false;
+    FileWriter::SyncMode saveSyncMode = FileWriter::NoSync;
+    int backgroundSaves = 0; // Queued or being written. Until they are finished, changes to the file are this editor's own.
+    std::shared_ptr<std::atomic<bool>> backgroundSaveCancelled; // Of the most recent background save
+    std::shared_ptr<QMutex> backgroundWriteMutex; // Held by a background save while it writes the file
 
     bool readFromDisk(QFile &file);
+    bool readFromDiskInBackground(QFile &file, QThreadPool *pool);
+    bool openPaged(QFile &file);
+    void attachLoadedDocument(void *document);
+    bool wakeUp();
+    void applyReload(const FileReloader *fileReloader);
+    void reloadFromScratch();
+    void applyAnalysis(const FileAnalyzer &analyzer);
+    QFileDevice::FileError writeToDisk(const QString &path) const;
+    FileWriter createWriter(const QString &path) const;
+    void cancelBackgroundSaves();
+    void finishBackgroundSave(QFileDevice::FileError error, quint64 savedGeneration);
     QDateTime fileTimestamp();
     void updateTimestamp();
 
@@ -156,22 +273,22 @@ private:
 template<typename Func>
 void ScintillaNext::forEachLineInSelection(int selection, Func callback)
 {
-    int lineStart = lineFromPosition(selectionNStart(selection));
-    int lineEnd = lineFromPosition(selectionNEnd(selection));
+    const Sci_Position lineStart = lineFromPosition(selectionNStart(selection));
+    const Sci_Position lineEnd = lineFromPosition(selectionNEnd(selection));
 
-    for (int curLine = lineStart; curLine <= lineEnd; ++curLine) {
+    for (Sci_Position curLine = lineStart; curLine <= lineEnd; ++curLine) {
         callback(curLine);
     }
 }
 
 // Stick this in the header file...because C++, that's why
 template<typename Func>
-void ScintillaNext::forEachMatchInRange(const QByteArray &text, Func callback, Sci_CharacterRange range)
+void ScintillaNext::forEachMatchInRange(const QByteArray &text, Func callback, Sci_CharacterRangeFull range)
 {
-    Sci_TextToFind ttf {range, text.constData(), {-1, -1}};
+    Sci_TextToFindFull ttf {range, text.constData(), {-1, -1}};
     int flags = searchFlags();
 
-    while (send(SCI_FINDTEXT, flags, reinterpret_cast<sptr_t>(&ttf)) != -1) {
+    while (send(SCI_FINDTEXTFULL, flags, reinterpret_cast<sptr_t>(&ttf)) != -1) {
         if(ttf.chrgText.cpMin == ttf.chrgText.cpMax)
             break;
         ttf.chrg.cpMin = callback(ttf.chrgText.cpMin, ttf.chrgText.cpMax);
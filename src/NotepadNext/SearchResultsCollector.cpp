@@ -40,7 +40,18 @@ void SearchResultsCollector::newFileEntry(ScintillaNext *editor)
     child->newFileEntry(editor);
 }
 
-void SearchResultsCollector::newResultsEntry(const QString line, int lineNumber, int startPositionFromBeginning, int endPositionFromBeginning, int hitCount)
+void SearchResultsCollector::newFileEntry(const QString filePath)
+{
+    // There may be a result that was not passed along yet
+    if (runningHitCount > 0) {
+        child->newResultsEntry(prevLine, prevLineNumber, prevStartPositionFromBeginning, prevEndPositionFromBeginning, runningHitCount);
+    }
+    runningHitCount = 0;
+
+    child->newFileEntry(filePath);
+}
+
+void SearchResultsCollector::newResultsEntry(const QString line, Sci_Position lineNumber, Sci_Position startPositionFromBeginning, Sci_Position endPositionFromBeginning, int hitCount)
 {
     if (runningHitCount == 0) {
         // Save the previous results since there have not been any yet
@@ -30,7 +30,8 @@ public:
 
     void newSearch(const QString searchTerm) override;
     void newFileEntry(ScintillaNext *editor) override;
-    void newResultsEntry(const QString line, int lineNumber, int startPositionFromBeginning, int endPositionFromBeginning, int hitCount=1) override;
+    void newFileEntry(const QString filePath) override;
+    void newResultsEntry(const QString line, Sci_Position lineNumber, Sci_Position startPositionFromBeginning, Sci_Position endPositionFromBeginning, int hitCount=1) override;
     void completeSearch() override;
 
 private:
@@ -38,8 +39,8 @@ private:
     int runningHitCount = 0;
 
     QString prevLine;
-    int prevLineNumber;
-    int prevStartPositionFromBeginning;
-    int prevEndPositionFromBeginning;
+    Sci_Position prevLineNumber;
+    Sci_Position prevStartPositionFromBeginning;
+    Sci_Position prevEndPositionFromBeginning;
 };
 
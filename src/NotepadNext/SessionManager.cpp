@@ -20,11 +20,16 @@
 #include "ScintillaNext.h"
 #include "MainWindow.h"
 #include "SessionManager.h"
+#include "EditJournal.h"
 #include "EditorManager.h"
 #include "NotepadNextApplication.h"
 
+#include <QDataStream>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QSharedPointer>
 #include <QStandardPaths>
+#include <QTextCodec>
 #include <QUuid>
 
 
@@ -54,9 +59,109 @@ QDir SessionManager::sessionDirectory() const
     return d;
 }
 
-void SessionManager::saveIntoSessionDirectory(ScintillaNext *editor, const QString &sessionFileName) const
+bool SessionManager::saveIntoSessionDirectory(ScintillaNext *editor, const QString &sessionFileName) const
 {
-    editor->saveCopyAs(sessionDirectory().filePath(sessionFileName));
+    // Kept as UTF-8 since it is read back as UTF-8 and the journal's positions are into the UTF-8 text
+    return editor->saveRawCopyAs(sessionDirectory().filePath(sessionFileName)) == QFileDevice::NoError;
+}
+
+QString SessionManager::storeIntoSessionDirectory(ScintillaNext *editor)
+{
+    // The editor keeps using the same session file until the text changes, so unchanged buffers are never written again
+    QString sessionFileName = editor->QObject::property("nn_session_file_name").toString();
+    const QVariant generation = editor->QObject::property("nn_session_generation");
+
+    const bool upToDate = !sessionFileName.isEmpty()
+                          && generation.isValid()
+                          && generation.toULongLong() == editor->modificationGeneration()
+                          && sessionDirectory().exists(sessionFileName);
+
+    if (!upToDate) {
+        // Changed text goes into a new file. The old file and its journal are only removed once the session
+        // manifest points to the new one, so a crash in between still leaves something to recover from.
+        const QString newSessionFileName = RandomSessionFileName();
+
+        if (saveIntoSessionDirectory(editor, newSessionFileName)) {
+            rememberSessionFile(editor, newSessionFileName, editor->modificationGeneration());
+            sessionFileName = newSessionFileName;
+            sessionFilesWritten++;
+        }
+        else if (sessionFileName.isEmpty()) {
+            // There is nothing to fall back to, the entry gets skipped when the session is loaded since the file is missing
+            return newSessionFileName;
+        }
+    }
+
+    sessionFilesInUse.insert(sessionFileName);
+
+    return sessionFileName;
+}
+
+void SessionManager::rememberSessionFile(ScintillaNext *editor, const QString &sessionFileName, quint64 generation) const
+{
+    editor->QObject::setProperty("nn_session_file_name", sessionFileName);
+    editor->QObject::setProperty("nn_session_generation", static_cast<qulonglong>(generation));
+
+    // Anything typed from here on is journaled until the next time the text is written to a session file
+    EditJournal *journal = editor->findChild<EditJournal *>(QString(), Qt::FindDirectChildrenOnly);
+
+    if (journal == Q_NULLPTR) {
+        journal = new EditJournal(editor);
+    }
+
+    journal->setFilePath(journalFilePath(sessionFileName));
+}
+
+void SessionManager::forgetSessionFile(ScintillaNext *editor) const
+{
+    editor->QObject::setProperty("nn_session_file_name", QVariant());
+    editor->QObject::setProperty("nn_session_generation", QVariant());
+
+    delete editor->findChild<EditJournal *>(QString(), Qt::FindDirectChildrenOnly);
+}
+
+QString SessionManager::journalFilePath(const QString &sessionFileName) const
+{
+    return sessionDirectory().filePath(sessionFileName + QStringLiteral(".journal"));
+}
+
+void SessionManager::reuseSessionFile(ScintillaNext *editor, const QString &sessionFileName) const
+{
+    // A background load swaps in a new document, so wait until the text is actually there
+    if (editor->isLoading()) {
+        QObject::connect(editor, &ScintillaNext::loadFinished, editor, [=](bool success) {
+            if (success) {
+                reuseSessionFile(editor, sessionFileName);
+            }
+        });
+        return;
+    }
+
+    // The session file is up to date with the text that was just read from it. Anything in the journal is what
+    // was typed after that and never made it into a session file, e.g. because of a crash.
+    const quint64 generation = editor->modificationGeneration();
+    const int recovered = EditJournal::replay(journalFilePath(sessionFileName), editor);
+
+    if (recovered > 0) {
+        qInfo("Recovered %d edit(s) to \"%s\" from its journal", recovered, qUtf8Printable(editor->getName()));
+    }
+
+    // Keep appending to the same journal, the recovered edits only need written to a session file on the next save
+    rememberSessionFile(editor, sessionFileName, generation);
+}
+
+void SessionManager::removeUnusedSessionFiles() const
+{
+    QDir d = sessionDirectory();
+
+    const QString manifestFileName = QFileInfo(manifestFilePath()).fileName();
+
+    // Journals go along with the session file they are named after
+    for (const QString &f : d.entryList(QDir::Files)) {
+        if (f != manifestFileName && !sessionFilesInUse.contains(QFileInfo(f).completeBaseName())) {
+            d.remove(f);
+        }
+    }
 }
 
 SessionManager::SessionFileType SessionManager::determineType(ScintillaNext *editor) const
@@ -107,123 +212,124 @@ void SessionManager::saveSession(MainWindow *window)
 {
     qInfo(Q_FUNC_INFO);
 
-    clear();
+    QElapsedTimer timer;
+    timer.start();
+
+    // Sessions used to be kept in the settings, they are only ever read from there now to bring back an older session
+    clearSettings();
 
     // Early out if no flags are set
     if (fileTypes == SessionManager::None) {
+        for (const auto &editor : window->editors()) {
+            forgetSessionFile(editor);
+        }
+
+        clearDirectory();
         return;
     }
 
+    sessionFilesInUse.clear();
+    sessionFilesWritten = 0;
+
     const ScintillaNext *currentEditor = window->currentEditor();
-    int currentEditorIndex = 0;
-    QSettings settings;
+    SessionManifest manifest;
 
-    settings.beginGroup("CurrentSession");
+    for (const auto &editor : window->editors()) {
+        SessionFileType editorType = determineType(editor);
 
-    settings.beginWriteArray("OpenedFiles");
+        // Only buffers that are kept in a session file need journaled
+        if ((editorType != SessionManager::UnsavedFile && editorType != SessionManager::TempFile) || !fileTypes.testFlag(editorType)) {
+            forgetSessionFile(editor);
+        }
 
-    int index = 0;
-    for (const auto &editor : window->editors()) {
-        settings.setArrayIndex(index);
+        if (editorType == SessionManager::None || !fileTypes.testFlag(editorType)) {
+            continue;
+        }
 
-        SessionFileType editorType = determineType(editor);
+        SessionEntry entry;
 
         if (editorType == SessionManager::SavedFile) {
-            if (fileTypes.testFlag(SessionManager::SavedFile)) {
-                storeFileDetails(editor, settings);
-            }
-            else {
-                continue;
-            }
+            storeFileDetails(editor, entry);
         }
         else if (editorType == SessionManager::UnsavedFile) {
-            if (fileTypes.testFlag(SessionManager::UnsavedFile)) {
-                storeUnsavedFileDetails(editor, settings);
-            }
-            else {
-                continue;
-            }
+            storeUnsavedFileDetails(editor, entry);
         }
         else if (editorType == SessionManager::TempFile) {
-            if (fileTypes.testFlag(SessionManager::TempFile)) {
-                storeTempFile(editor, settings);
-            }
-            else {
-                continue;
-            }
-        }
-        else {
-            continue;
+            storeTempFile(editor, entry);
         }
 
         if (currentEditor == editor) {
-            currentEditorIndex = index;
+            manifest.currentIndex = manifest.entries.size();
         }
 
-        ++index;
+        manifest.entries.append(entry);
     }
 
-    settings.endArray();
-
-    settings.setValue("CurrentEditorIndex", currentEditorIndex);
+    // The manifest needs to be on disk before the session files it no longer points to are removed
+    if (manifest.write(manifestFilePath())) {
+        removeUnusedSessionFiles();
+    }
 
-    settings.endGroup();
+    qInfo("Saved session with %d entries in %lld ms, %d of %d session files written", static_cast<int>(manifest.entries.size()), timer.elapsed(), sessionFilesWritten, static_cast<int>(sessionFilesInUse.size()));
 }
 
 void SessionManager::loadSession(MainWindow *window)
 {
     qInfo(Q_FUNC_INFO);
 
-    QSettings settings;
+    QElapsedTimer timer;
+    timer.start();
 
-    settings.beginGroup("CurrentSession");
+    SessionManifest manifest;
+
+    if (QFileInfo::exists(manifestFilePath())) {
+        manifest.read(manifestFilePath());
+    }
+    else {
+        readLegacySession(manifest);
+    }
+
+    qInfo("Read session with %d entries in %lld ms", static_cast<int>(manifest.entries.size()), timer.elapsed());
+
+    // Only the editor that is going to be shown gets read now, the rest wait until they are needed
+    const bool onDemand = app->getSettings()->restoreFilesOnDemand();
 
     ScintillaNext *currentEditor = Q_NULLPTR;
-    const int currentEditorIndex = settings.value("CurrentEditorIndex").toInt();
-    const int size = settings.beginReadArray("OpenedFiles");
 
     // NOTE: In theory the fileTypes should determine what is loaded, however if the session fileTypes
-    // change from the last time it was saved then it means the settings were manually altered outside of the app,
+    // change from the last time it was saved then it means the session was manually altered outside of the app,
     // which is non-standard behavior, so just load anything in the file
 
-    for (int index = 0; index < size; ++index) {
-        settings.setArrayIndex(index);
-
+    for (int index = 0; index < manifest.entries.size(); ++index) {
+        const SessionEntry &entry = manifest.entries.at(index);
         ScintillaNext *editor = Q_NULLPTR;
 
-        if (settings.contains("Type")) {
-            const QString type = settings.value("Type").toString();
-
-            if (type == QStringLiteral("File")) {
-                editor = loadFileDetails(settings);
-            }
-            else if (type == QStringLiteral("UnsavedFile")) {
-                editor = loadUnsavedFileDetails(settings);
-            }
-            else if (type == QStringLiteral("Temp")) {
-                editor = loadTempFile(settings);
-            }
-            else {
-                qDebug("Unknown session entry type: %s", qUtf8Printable(type));
-            }
-
-            if (editor) {
-                 if (currentEditorIndex == index) {
-                    currentEditor = editor;
-                }
-            }
+        if (entry.type == SessionEntry::File) {
+            editor = loadFileDetails(entry, onDemand && index != manifest.currentIndex);
         }
-        else {
-            qDebug("Unknown session entry type for index %d", index);
+        else if (entry.type == SessionEntry::UnsavedFile) {
+            editor = loadUnsavedFileDetails(entry);
+        }
+        else if (entry.type == SessionEntry::Temp) {
+            editor = loadTempFile(entry);
         }
-    }
 
-    settings.endArray();
+        if (editor && manifest.currentIndex == index) {
+            currentEditor = editor;
+        }
+    }
 
-    settings.endGroup();
+    qInfo("Restored %d session entries in %lld ms", static_cast<int>(manifest.entries.size()), timer.elapsed());
 
     if (currentEditor) {
         window->switchToEditor(currentEditor);
+
+        // How long it takes until there is something to look at is what matters the most when starting up
+        auto connection = QSharedPointer<QMetaObject::Connection>::create();
+        *connection = QObject::connect(currentEditor, &ScintillaNext::painted, currentEditor, [=]() {
+            QObject::disconnect(*connection);
+            qInfo("First paint %lld ms after restoring the session (%s)", timer.elapsed(), onDemand ? "on demand" : "all files read");
+        });
     }
 }
 
@@ -235,19 +341,70 @@ bool SessionManager::willFileGetStoredInSession(ScintillaNext *editor) const
     return fileTypes.testFlag(editorType);
 }
 
-void SessionManager::storeFileDetails(ScintillaNext *editor, QSettings &settings)
+QString SessionManager::manifestFilePath() const
 {
-    settings.setValue("Type", "File");
-    settings.setValue("FilePath", editor->getFilePath());
+    return sessionDirectory().filePath(QStringLiteral("session.manifest"));
+}
 
-    storeEditorViewDetails(editor, settings);
+void SessionManager::readLegacySession(SessionManifest &manifest) const
+{
+    QSettings settings;
+
+    settings.beginGroup("CurrentSession");
+
+    manifest.currentIndex = settings.value("CurrentEditorIndex").toInt();
+    const int size = settings.beginReadArray("OpenedFiles");
+
+    for (int index = 0; index < size; ++index) {
+        settings.setArrayIndex(index);
+
+        const QString type = settings.value("Type").toString();
+        SessionEntry entry;
+
+        if (type == QStringLiteral("File")) {
+            entry.type = SessionEntry::File;
+        }
+        else if (type == QStringLiteral("UnsavedFile")) {
+            entry.type = SessionEntry::UnsavedFile;
+        }
+        else if (type == QStringLiteral("Temp")) {
+            entry.type = SessionEntry::Temp;
+        }
+        else {
+            qDebug("Unknown session entry type for index %d: %s", index, qUtf8Printable(type));
+
+            // Keep the indices lined up with the current editor index
+            entry.type = SessionEntry::File;
+        }
+
+        entry.filePath = settings.value("FilePath").toString();
+        entry.fileName = settings.value("FileName").toString();
+        entry.sessionFileName = settings.value("SessionFileName").toString();
+        entry.language = settings.value("Language").toString();
+        entry.view.firstVisibleLine = settings.value("FirstVisibleLine").toLongLong() - 1;
+        entry.view.currentPosition = settings.value("CurrentPosition").toLongLong();
+
+        manifest.entries.append(entry);
+    }
+
+    settings.endArray();
+
+    settings.endGroup();
+}
+
+void SessionManager::storeFileDetails(ScintillaNext *editor, SessionEntry &entry)
+{
+    entry.type = SessionEntry::File;
+    entry.filePath = editor->getFilePath();
+
+    storeEditorViewDetails(editor, entry);
 }
 
-ScintillaNext* SessionManager::loadFileDetails(QSettings &settings)
+ScintillaNext* SessionManager::loadFileDetails(const SessionEntry &entry, bool onDemand)
 {
     qInfo(Q_FUNC_INFO);
 
-    const QString filePath = settings.value("FilePath").toString();
+    const QString &filePath = entry.filePath;
 
     qDebug("Session file: \"%s\"", qUtf8Printable(filePath));
 
@@ -258,12 +415,12 @@ ScintillaNext* SessionManager::loadFileDetails(QSettings &settings)
     }
 
     if (QFileInfo::exists(filePath)) {
-        editor = ScintillaNext::fromFile(filePath);
-
-        loadEditorViewDetails(editor, settings);
+        editor = onDemand ? ScintillaNext::placeholderForFile(filePath) : ScintillaNext::fromFile(filePath);
 
         app->getEditorManager()->manageEditor(editor);
 
+        loadEditorViewDetails(editor, entry);
+
         return editor;
     }
     else {
@@ -272,25 +429,23 @@ ScintillaNext* SessionManager::loadFileDetails(QSettings &settings)
     }
 }
 
-void SessionManager::storeUnsavedFileDetails(ScintillaNext *editor, QSettings &settings)
+void SessionManager::storeUnsavedFileDetails(ScintillaNext *editor, SessionEntry &entry)
 {
-    const QString sessionFileName = RandomSessionFileName();
+    entry.type = SessionEntry::UnsavedFile;
+    entry.filePath = editor->getFilePath();
+    entry.sessionFileName = storeIntoSessionDirectory(editor);
+    entry.encoding = editor->getCodec() ? editor->getCodec()->name() : QByteArray();
+    entry.bom = editor->hasBom();
 
-    settings.setValue("Type", "UnsavedFile");
-    settings.setValue("FilePath", editor->getFilePath());
-    settings.setValue("SessionFileName", sessionFileName);
-
-    storeEditorViewDetails(editor, settings);
-
-    saveIntoSessionDirectory(editor, sessionFileName);
+    storeEditorViewDetails(editor, entry);
 }
 
-ScintillaNext *SessionManager::loadUnsavedFileDetails(QSettings &settings)
+ScintillaNext *SessionManager::loadUnsavedFileDetails(const SessionEntry &entry)
 {
     qInfo(Q_FUNC_INFO);
 
-    const QString filePath = settings.value("FilePath").toString();
-    const QString sessionFileName = settings.value("SessionFileName").toString();
+    const QString &filePath = entry.filePath;
+    const QString &sessionFileName = entry.sessionFileName;
     const QString sessionFilePath = sessionDirectory().filePath(sessionFileName);
 
     qDebug("Session file: \"%s\"", qUtf8Printable(filePath));
@@ -302,17 +457,30 @@ ScintillaNext *SessionManager::loadUnsavedFileDetails(QSettings &settings)
         return Q_NULLPTR;
     }
 
-    if (QFileInfo::exists(filePath) && QFileInfo::exists(sessionFilePath)) {
+    if (QFileInfo::exists(filePath) && !sessionFileName.isEmpty() && QFileInfo::exists(sessionFilePath)) {
         ScintillaNext *editor = ScintillaNext::fromFile(sessionFilePath);
 
         // Since this editor has different file path info, treat this as a temporary buffer
         editor->setFileInfo(filePath);
         editor->setTemporary(true);
 
-        loadEditorViewDetails(editor, settings);
+        // The session copy is always UTF-8, the file itself gets saved back the way it was
+        QTextCodec *codec = entry.encoding.isEmpty() ? Q_NULLPTR : QTextCodec::codecForName(entry.encoding);
+        const bool bom = entry.bom;
+
+        if (editor->isLoading()) {
+            QObject::connect(editor, &ScintillaNext::loadFinished, editor, [=]() { editor->setEncoding(codec, bom); });
+        }
+        else {
+            editor->setEncoding(codec, bom);
+        }
+
+        reuseSessionFile(editor, sessionFileName);
 
         app->getEditorManager()->manageEditor(editor);
 
+        loadEditorViewDetails(editor, entry);
+
         return editor;
     }
     else {
@@ -322,45 +490,34 @@ ScintillaNext *SessionManager::loadUnsavedFileDetails(QSettings &settings)
     }
 }
 
-void SessionManager::storeTempFile(ScintillaNext *editor, QSettings &settings)
+void SessionManager::storeTempFile(ScintillaNext *editor, SessionEntry &entry)
 {
-    const QString sessionFileName = RandomSessionFileName();
-
-    settings.setValue("Type", "Temp");
-    settings.setValue("FileName", editor->getName());
-    settings.setValue("SessionFileName", sessionFileName);
-    settings.setValue("Language", editor->languageName);
+    entry.type = SessionEntry::Temp;
+    entry.fileName = editor->getName();
+    entry.sessionFileName = storeIntoSessionDirectory(editor);
 
-    storeEditorViewDetails(editor, settings);
-
-    saveIntoSessionDirectory(editor, sessionFileName);
+    storeEditorViewDetails(editor, entry);
 }
 
-ScintillaNext *SessionManager::loadTempFile(QSettings &settings)
+ScintillaNext *SessionManager::loadTempFile(const SessionEntry &entry)
 {
     qInfo(Q_FUNC_INFO);
 
-    const QString fileName = settings.value("FileName").toString();
-    const QString sessionFileName = settings.value("SessionFileName").toString();
-    const QString languageName = settings.value("Language", QString()).toString();
-    const QString fullFilePath = sessionDirectory().filePath(sessionFileName);
+    const QString fullFilePath = sessionDirectory().filePath(entry.sessionFileName);
 
     qDebug("Session temp file: \"%s\"", qUtf8Printable(fullFilePath));
 
-    if (QFileInfo::exists(fullFilePath)) {
+    if (!entry.sessionFileName.isEmpty() && QFileInfo::exists(fullFilePath)) {
         ScintillaNext *editor = ScintillaNext::fromFile(fullFilePath, false);
 
-        editor->detachFileInfo(fileName);
+        editor->detachFileInfo(entry.fileName);
         editor->setTemporary(true);
 
-        loadEditorViewDetails(editor, settings);
+        reuseSessionFile(editor, entry.sessionFileName);
 
         app->getEditorManager()->manageEditor(editor);
 
-        if (!languageName.isEmpty()) {
-            qDebug("Setting session file language to \"%s\"", qUtf8Printable(languageName));
-            app->setEditorLanguage(editor, languageName);
-        }
+        loadEditorViewDetails(editor, entry);
 
         return editor;
     }
@@ -370,17 +527,55 @@ ScintillaNext *SessionManager::loadTempFile(QSettings &settings)
     }
 }
 
-void SessionManager::storeEditorViewDetails(ScintillaNext *editor, QSettings &settings)
+void SessionManager::storeEditorViewDetails(ScintillaNext *editor, SessionEntry &entry)
 {
-    settings.setValue("FirstVisibleLine", static_cast<int>(editor->firstVisibleLine() + 1)); // Keep it 1-based in the settings just for human-readability
-    settings.setValue("CurrentPosition", static_cast<int>(editor->currentPos()));
+    entry.language = editor->languageName;
+
+    // Placeholders have not been looked at yet, so keep what they were restored with
+    if (editor->isPlaceholder()) {
+        QByteArray data = editor->QObject::property("nn_session_view").toByteArray();
+        QDataStream stream(&data, QIODevice::ReadOnly);
+
+        stream >> entry.view;
+    }
+    else if (editor->isHibernated()) {
+        entry.view = editor->hibernatedViewState();
+    }
+    else {
+        entry.view = EditorViewState::capture(editor);
+    }
 }
 
-void SessionManager::loadEditorViewDetails(ScintillaNext *editor, QSettings &settings)
+void SessionManager::loadEditorViewDetails(ScintillaNext *editor, const SessionEntry &entry)
 {
-    const int firstVisibleLine = settings.value("FirstVisibleLine").toInt() - 1;
-    const int currentPosition = settings.value("CurrentPosition").toInt();
+    const EditorViewState view = entry.view;
+
+    if (!entry.language.isEmpty()) {
+        if (editor->isPlaceholder()) {
+            // Setting up the lexer waits until there is text to use it on
+            editor->languageName = entry.language;
+        }
+        else {
+            qDebug("Setting session file language to \"%s\"", qUtf8Printable(entry.language));
+            app->setEditorLanguage(editor, entry.language);
+        }
+    }
+
+    if (editor->isPlaceholder()) {
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+
+        stream << view;
+        editor->QObject::setProperty("nn_session_view", data);
+    }
+
+    // The positions are meaningless until the text is actually there
+    if (editor->isLoading()) {
+        QObject::connect(editor, &ScintillaNext::loadFinished, editor, [=]() {
+            view.apply(editor);
+        });
+        return;
+    }
 
-    editor->setFirstVisibleLine(firstVisibleLine);
-    editor->setEmptySelection(currentPosition);
+    view.apply(editor);
 }
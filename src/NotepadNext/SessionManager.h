@@ -22,8 +22,11 @@
 
 
 #include <QDir>
+#include <QSet>
 #include <QSettings>
 
+#include "SessionManifest.h"
+
 
 class ScintillaNext;
 class MainWindow;
@@ -55,27 +58,40 @@ public:
 private:
     QDir sessionDirectory() const;
 
-    void saveIntoSessionDirectory(ScintillaNext *editor, const QString &sessionFileName) const;
+    bool saveIntoSessionDirectory(ScintillaNext *editor, const QString &sessionFileName) const;
+    QString storeIntoSessionDirectory(ScintillaNext *editor);
+    void rememberSessionFile(ScintillaNext *editor, const QString &sessionFileName, quint64 generation) const;
+    void forgetSessionFile(ScintillaNext *editor) const;
+    QString journalFilePath(const QString &sessionFileName) const;
+    void reuseSessionFile(ScintillaNext *editor, const QString &sessionFileName) const;
+    void removeUnusedSessionFiles() const;
 
     SessionFileType determineType(ScintillaNext *editor) const;
 
     void clearSettings() const;
     void clearDirectory() const;
 
-    void storeFileDetails(ScintillaNext *editor, QSettings &settings);
-    ScintillaNext *loadFileDetails(QSettings &settings);
+    QString manifestFilePath() const;
+    void readLegacySession(SessionManifest &manifest) const;
+
+    void storeFileDetails(ScintillaNext *editor, SessionEntry &entry);
+    ScintillaNext *loadFileDetails(const SessionEntry &entry, bool onDemand);
 
-    void storeUnsavedFileDetails(ScintillaNext *editor, QSettings &settings);
-    ScintillaNext *loadUnsavedFileDetails(QSettings &settings);
+    void storeUnsavedFileDetails(ScintillaNext *editor, SessionEntry &entry);
+    ScintillaNext *loadUnsavedFileDetails(const SessionEntry &entry);
 
-    void storeTempFile(ScintillaNext *editor, QSettings &settings);
-    ScintillaNext *loadTempFile(QSettings &settings);
+    void storeTempFile(ScintillaNext *editor, SessionEntry &entry);
+    ScintillaNext *loadTempFile(const SessionEntry &entry);
 
-    void storeEditorViewDetails(ScintillaNext *editor, QSettings &settings);
-    void loadEditorViewDetails(ScintillaNext *editor, QSettings &settings);
+    void storeEditorViewDetails(ScintillaNext *editor, SessionEntry &entry);
+    void loadEditorViewDetails(ScintillaNext *editor, const SessionEntry &entry);
 
     NotepadNextApplication *app;
     SessionFileTypes fileTypes;
+
+    // Filled in while saving the session
+    QSet<QString> sessionFilesInUse;
+    int sessionFilesWritten = 0;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(SessionManager::SessionFileTypes)
@@ -0,0 +1,144 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "SessionManifest.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+
+
+// Kept fixed so the manifest can be read no matter which Qt version wrote it
+const QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_12;
+
+
+// These live here rather than with the rest of EditorViewState so the manifest does not need an editor
+QDataStream &operator<<(QDataStream &stream, const EditorViewState &state)
+{
+    return stream << state.firstVisibleLine << state.currentPosition << state.selections << state.mainSelection
+                  << state.foldedLines << state.bookmarkedLines;
+}
+
+QDataStream &operator>>(QDataStream &stream, EditorViewState &state)
+{
+    return stream >> state.firstVisibleLine >> state.currentPosition >> state.selections >> state.mainSelection
+                  >> state.foldedLines >> state.bookmarkedLines;
+}
+
+static void readEntry(QDataStream &stream, SessionEntry &entry, quint32 version)
+{
+    quint8 type;
+
+    stream >> type >> entry.filePath >> entry.fileName >> entry.sessionFileName >> entry.language >> entry.view;
+
+    if (version >= 2) {
+        stream >> entry.encoding >> entry.bom;
+    }
+
+    if (type > SessionEntry::Temp) {
+        stream.setStatus(QDataStream::ReadCorruptData);
+    }
+
+    entry.type = static_cast<SessionEntry::Type>(type);
+}
+
+QDataStream &operator<<(QDataStream &stream, const SessionEntry &entry)
+{
+    return stream << static_cast<quint8>(entry.type) << entry.filePath << entry.fileName << entry.sessionFileName
+                  << entry.language << entry.view << entry.encoding << entry.bom;
+}
+
+QDataStream &operator>>(QDataStream &stream, SessionEntry &entry)
+{
+    readEntry(stream, entry, SessionManifest::VERSION);
+
+    return stream;
+}
+
+bool SessionManifest::read(const QString &filePath)
+{
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(STREAM_VERSION);
+
+    quint32 magic;
+    quint32 version;
+    qint32 index;
+
+    stream >> magic >> version;
+
+    if (stream.status() != QDataStream::Ok || magic != MAGIC) {
+        qWarning("\"%s\" is not a session manifest", qUtf8Printable(filePath));
+        return false;
+    }
+
+    if (version == 0 || version > VERSION) {
+        qWarning("Session manifest \"%s\" is version %u, only up to version %u is supported", qUtf8Printable(filePath), version, VERSION);
+        return false;
+    }
+
+    quint32 count;
+
+    stream >> index >> count;
+
+    // Read the same way QVector does, but older versions have less in each entry
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        SessionEntry entry;
+        readEntry(stream, entry, version);
+        entries.append(entry);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning("Session manifest \"%s\" is corrupt", qUtf8Printable(filePath));
+        entries.clear();
+        return false;
+    }
+
+    currentIndex = index;
+
+    return true;
+}
+
+bool SessionManifest::write(const QString &filePath) const
+{
+    // Either the whole manifest gets replaced or none of it does
+    QSaveFile file(filePath);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning("Unable to write session manifest \"%s\": %s", qUtf8Printable(filePath), qUtf8Printable(file.errorString()));
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(STREAM_VERSION);
+
+    stream << MAGIC << VERSION << static_cast<qint32>(currentIndex) << entries;
+
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        qWarning("Unable to write session manifest \"%s\": %s", qUtf8Printable(filePath), qUtf8Printable(file.errorString()));
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,68 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SESSIONMANIFEST_H
+#define SESSIONMANIFEST_H
+
+#include "EditorViewState.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+
+class QDataStream;
+
+// Everything needed to bring back one tab
+struct SessionEntry
+{
+    enum Type : quint8 {
+        File = 0,
+        UnsavedFile = 1,
+        Temp = 2,
+    };
+
+    Type type = File;
+    QString filePath; // File and UnsavedFile
+    QString fileName; // Temp
+    QString sessionFileName; // UnsavedFile and Temp, the copy of the text in the session directory
+    QString language;
+    EditorViewState view;
+    QByteArray encoding; // UnsavedFile, the codec the file gets saved with. Empty for UTF-8.
+    bool bom = false; // UnsavedFile
+};
+
+QDataStream &operator<<(QDataStream &stream, const SessionEntry &entry);
+QDataStream &operator>>(QDataStream &stream, SessionEntry &entry);
+
+// The list of tabs in a session, stored as one binary file that gets read in a single pass
+class SessionManifest
+{
+public:
+    static const quint32 MAGIC = 0x4E4E534D; // "NNSM"
+    static const quint32 VERSION = 2; // Version 1 had no encodings
+
+    bool read(const QString &filePath);
+    bool write(const QString &filePath) const;
+
+    int currentIndex = 0;
+    QVector<SessionEntry> entries;
+};
+
+#endif // SESSIONMANIFEST_H
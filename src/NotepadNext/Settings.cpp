@@ -34,9 +34,18 @@ bool Settings::tabsClosable() const { return m_tabsClosable; }
 bool Settings::restorePreviousSession() const { return m_restorePreviousSession; }
 bool Settings::restoreUnsavedFiles() const { return m_restoreUnsavedFiles; }
 bool Settings::restoreTempFiles() const { return m_restoreTempFiles; }
+bool Settings::restoreFilesOnDemand() const { return m_restoreFilesOnDemand; }
+int Settings::sessionSnapshotInterval() const { return m_sessionSnapshotInterval; }
 
 bool Settings::combineSearchResults() const { return m_combineSearchResults; }
 
+bool Settings::atomicSave() const { return m_atomicSave; }
+FileWriter::SyncMode Settings::saveSyncMode() const { return m_saveSyncMode; }
+bool Settings::backgroundSave() const { return m_backgroundSave; }
+
+int Settings::maxConcurrentLoads() const { return m_maxConcurrentLoads; }
+int Settings::hibernateAfter() const { return m_hibernateAfter; }
+
 void Settings::setShowMenuBar(bool showMenuBar)
 {
     if (m_showMenuBar == showMenuBar)
@@ -109,6 +118,24 @@ void Settings::setRestoreTempFiles(bool restoreTempFiles)
     emit restoreTempFilesChanged(m_restoreTempFiles);
 }
 
+void Settings::setRestoreFilesOnDemand(bool restoreFilesOnDemand)
+{
+    if (m_restoreFilesOnDemand == restoreFilesOnDemand)
+        return;
+
+    m_restoreFilesOnDemand = restoreFilesOnDemand;
+    emit restoreFilesOnDemandChanged(m_restoreFilesOnDemand);
+}
+
+void Settings::setSessionSnapshotInterval(int sessionSnapshotInterval)
+{
+    if (m_sessionSnapshotInterval == sessionSnapshotInterval)
+        return;
+
+    m_sessionSnapshotInterval = sessionSnapshotInterval;
+    emit sessionSnapshotIntervalChanged(m_sessionSnapshotInterval);
+}
+
 void Settings::setCombineSearchResults(bool combineSearchResults)
 {
     if (m_combineSearchResults == combineSearchResults)
@@ -117,3 +144,48 @@ void Settings::setCombineSearchResults(bool combineSearchResults)
     m_combineSearchResults = combineSearchResults;
     emit combineSearchResultsChanged(m_combineSearchResults);
 }
+
+void Settings::setAtomicSave(bool atomicSave)
+{
+    if (m_atomicSave == atomicSave)
+        return;
+
+    m_atomicSave = atomicSave;
+    emit atomicSaveChanged(m_atomicSave);
+}
+
+void Settings::setSaveSyncMode(FileWriter::SyncMode saveSyncMode)
+{
+    if (m_saveSyncMode == saveSyncMode)
+        return;
+
+    m_saveSyncMode = saveSyncMode;
+    emit saveSyncModeChanged(m_saveSyncMode);
+}
+
+void Settings::setBackgroundSave(bool backgroundSave)
+{
+    if (m_backgroundSave == backgroundSave)
+        return;
+
+    m_backgroundSave = backgroundSave;
+    emit backgroundSaveChanged(m_backgroundSave);
+}
+
+void Settings::setMaxConcurrentLoads(int maxConcurrentLoads)
+{
+    if (m_maxConcurrentLoads == maxConcurrentLoads)
+        return;
+
+    m_maxConcurrentLoads = maxConcurrentLoads;
+    emit maxConcurrentLoadsChanged(m_maxConcurrentLoads);
+}
+
+void Settings::setHibernateAfter(int hibernateAfter)
+{
+    if (m_hibernateAfter == hibernateAfter)
+        return;
+
+    m_hibernateAfter = hibernateAfter;
+    emit hibernateAfterChanged(m_hibernateAfter);
+}
@@ -23,6 +23,8 @@
 #include <QObject>
 #include <QVariant>
 
+#include "FileWriter.h"
+
 class Settings : public QObject
 {
     Q_OBJECT
@@ -37,9 +39,18 @@ class Settings : public QObject
     Q_PROPERTY(bool restorePreviousSession READ restorePreviousSession WRITE setRestorePreviousSession NOTIFY restorePreviousSessionChanged)
     Q_PROPERTY(bool restoreUnsavedFiles READ restoreUnsavedFiles WRITE setRestoreUnsavedFiles NOTIFY restoreUnsavedFilesChanged)
     Q_PROPERTY(bool restoreTempFiles READ restoreTempFiles WRITE setRestoreTempFiles NOTIFY restoreTempFilesChanged)
+    Q_PROPERTY(bool restoreFilesOnDemand READ restoreFilesOnDemand WRITE setRestoreFilesOnDemand NOTIFY restoreFilesOnDemandChanged)
+    Q_PROPERTY(int sessionSnapshotInterval READ sessionSnapshotInterval WRITE setSessionSnapshotInterval NOTIFY sessionSnapshotIntervalChanged)
 
     Q_PROPERTY(bool combineSearchResults READ combineSearchResults WRITE setCombineSearchResults NOTIFY combineSearchResultsChanged)
 
+    Q_PROPERTY(bool atomicSave READ atomicSave WRITE setAtomicSave NOTIFY atomicSaveChanged)
+    Q_PROPERTY(FileWriter::SyncMode saveSyncMode READ saveSyncMode WRITE setSaveSyncMode NOTIFY saveSyncModeChanged)
+    Q_PROPERTY(bool backgroundSave READ backgroundSave WRITE setBackgroundSave NOTIFY backgroundSaveChanged)
+
+    Q_PROPERTY(int maxConcurrentLoads READ maxConcurrentLoads WRITE setMaxConcurrentLoads NOTIFY maxConcurrentLoadsChanged)
+    Q_PROPERTY(int hibernateAfter READ hibernateAfter WRITE setHibernateAfter NOTIFY hibernateAfterChanged)
+
     bool m_showMenuBar = true;
     bool m_showToolBar = true;
     bool m_showTabBar = true;
@@ -50,9 +61,18 @@ class Settings : public QObject
     bool m_restorePreviousSession = false;
     bool m_restoreUnsavedFiles = false;
     bool m_restoreTempFiles = false;
+    bool m_restoreFilesOnDemand = true;
+    int m_sessionSnapshotInterval = 60; // Seconds, 0 only saves it on exit
 
     bool m_combineSearchResults = false;
 
+    bool m_atomicSave = false;
+    FileWriter::SyncMode m_saveSyncMode = FileWriter::NoSync;
+    bool m_backgroundSave = false;
+
+    int m_maxConcurrentLoads = 4;
+    int m_hibernateAfter = 60; // Minutes, 0 never hibernates
+
 public:
     explicit Settings(QObject *parent = nullptr);
 
@@ -66,9 +86,18 @@ public:
     bool restorePreviousSession() const;
     bool restoreUnsavedFiles() const;
     bool restoreTempFiles() const;
+    bool restoreFilesOnDemand() const;
+    int sessionSnapshotInterval() const;
 
     bool combineSearchResults() const;
 
+    bool atomicSave() const;
+    FileWriter::SyncMode saveSyncMode() const;
+    bool backgroundSave() const;
+
+    int maxConcurrentLoads() const;
+    int hibernateAfter() const;
+
 signals:
     void showMenuBarChanged(bool showMenuBar);
     void showToolBarChanged(bool showToolBar);
@@ -80,9 +109,18 @@ signals:
     void restorePreviousSessionChanged(bool restorePreviousSession);
     void restoreUnsavedFilesChanged(bool restureUnsavedFiles);
     void restoreTempFilesChanged(bool restoreTempFiles);
+    void restoreFilesOnDemandChanged(bool restoreFilesOnDemand);
+    void sessionSnapshotIntervalChanged(int sessionSnapshotInterval);
 
     void combineSearchResultsChanged(bool combineSearchResults);
 
+    void atomicSaveChanged(bool atomicSave);
+    void saveSyncModeChanged(FileWriter::SyncMode saveSyncMode);
+    void backgroundSaveChanged(bool backgroundSave);
+
+    void maxConcurrentLoadsChanged(int maxConcurrentLoads);
+    void hibernateAfterChanged(int hibernateAfter);
+
 public slots:
     void setShowMenuBar(bool showMenuBar);
     void setShowToolBar(bool showToolBar);
@@ -94,8 +132,17 @@ public slots:
     void setRestorePreviousSession(bool restorePreviousSession);
     void setRestoreUnsavedFiles(bool restoreUnsavedFiles);
     void setRestoreTempFiles(bool restoreTempFiles);
+    void setRestoreFilesOnDemand(bool restoreFilesOnDemand);
+    void setSessionSnapshotInterval(int sessionSnapshotInterval);
 
     void setCombineSearchResults(bool combineSearchResults);
+
+    void setAtomicSave(bool atomicSave);
+    void setSaveSyncMode(FileWriter::SyncMode saveSyncMode);
+    void setBackgroundSave(bool backgroundSave);
+
+    void setMaxConcurrentLoads(int maxConcurrentLoads);
+    void setHibernateAfter(int hibernateAfter);
 };
 
 #endif // SETTINGS_H
@@ -0,0 +1,99 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "TabHibernator.h"
+#include "EditorManager.h"
+#include "ScintillaNext.h"
+
+#include <QDateTime>
+
+
+const int SWEEP_INTERVAL = 60 * 1000;
+
+
+TabHibernator::TabHibernator(EditorManager *editorManager, QObject *parent) :
+    QObject(parent)
+{
+    sweepTimer.setInterval(SWEEP_INTERVAL);
+
+    connect(&sweepTimer, &QTimer::timeout, this, &TabHibernator::hibernateIdleEditors);
+    connect(editorManager, &EditorManager::editorCreated, this, &TabHibernator::trackEditor);
+}
+
+void TabHibernator::setIdleTimeout(int minutes)
+{
+    idleTimeout = minutes * 60 * 1000LL;
+
+    if (idleTimeout > 0) {
+        sweepTimer.start();
+    }
+    else {
+        sweepTimer.stop();
+    }
+}
+
+void TabHibernator::editorActivated(ScintillaNext *editor)
+{
+    if (lastActive.contains(editor)) {
+        lastActive[editor] = QDateTime::currentMSecsSinceEpoch();
+    }
+}
+
+void TabHibernator::hibernateIdleEditors()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    int count = 0;
+    qint64 bytesFreed = 0;
+
+    for (auto it = lastActive.begin(); it != lastActive.end(); ++it) {
+        ScintillaNext *editor = it.key();
+
+        // Anything on screen is in use no matter when it was last activated, e.g. the other side of a split
+        if (editor->isVisible()) {
+            it.value() = now;
+            continue;
+        }
+
+        if (now - it.value() < idleTimeout || editor->isLoading()) {
+            continue;
+        }
+
+        const qint64 freed = editor->hibernate();
+
+        if (freed >= 0) {
+            qInfo("Hibernated \"%s\", freed about %lld KiB", qUtf8Printable(editor->getName()), freed / 1024);
+
+            count++;
+            bytesFreed += freed;
+        }
+    }
+
+    if (count > 0) {
+        totalBytesFreed += bytesFreed;
+
+        qInfo("Hibernated %d editor(s), freed about %lld KiB (%lld KiB since startup)", count, bytesFreed / 1024, totalBytesFreed / 1024);
+    }
+}
+
+void TabHibernator::trackEditor(ScintillaNext *editor)
+{
+    lastActive.insert(editor, QDateTime::currentMSecsSinceEpoch());
+
+    connect(editor, &QObject::destroyed, this, [=]() { lastActive.remove(editor); });
+}
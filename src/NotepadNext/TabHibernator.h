@@ -0,0 +1,57 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TABHIBERNATOR_H
+#define TABHIBERNATOR_H
+
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+
+
+class EditorManager;
+class ScintillaNext;
+
+// Hibernates editors that have not been looked at for a while so their documents don't sit in memory,
+// see ScintillaNext::hibernate(). They come back as soon as their tab is shown again.
+class TabHibernator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TabHibernator(EditorManager *editorManager, QObject *parent = Q_NULLPTR);
+
+    // In minutes, 0 turns hibernation off
+    void setIdleTimeout(int minutes);
+
+public slots:
+    void editorActivated(ScintillaNext *editor);
+    void hibernateIdleEditors();
+
+private:
+    void trackEditor(ScintillaNext *editor);
+
+    QTimer sweepTimer;
+    qint64 idleTimeout = 0;
+
+    QHash<ScintillaNext *, qint64> lastActive; // Milliseconds since the epoch
+    qint64 totalBytesFreed = 0;
+};
+
+#endif // TABHIBERNATOR_H
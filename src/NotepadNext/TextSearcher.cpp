@@ -0,0 +1,252 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "TextSearcher.h"
+#include "Scintilla.h"
+
+#include <algorithm>
+#include <climits>
+
+
+const qint64 MAX_LINE_TEXT = 1024; // More than this is not much use in the search results
+
+
+// The same classes Scintilla uses by default to decide where words start and end
+enum class CharClass { Space, Newline, Word, Punctuation };
+
+static CharClass classify(unsigned char c)
+{
+    if (c == '\r' || c == '\n')
+        return CharClass::Newline;
+    else if (c < 0x20 || c == ' ')
+        return CharClass::Space;
+    else if (c >= 0x80 || (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_')
+        return CharClass::Word;
+    else
+        return CharClass::Punctuation;
+}
+
+static bool isWordStartAt(const char *data, qint64 length, qint64 pos)
+{
+    if (pos >= length)
+        return false;
+
+    if (pos > 0) {
+        const CharClass cc = classify(data[pos]);
+        return (cc == CharClass::Word || cc == CharClass::Punctuation) && cc != classify(data[pos - 1]);
+    }
+
+    return true;
+}
+
+static bool isWordEndAt(const char *data, qint64 length, qint64 pos)
+{
+    if (pos <= 0)
+        return false;
+
+    if (pos < length) {
+        const CharClass ccPrev = classify(data[pos - 1]);
+        return (ccPrev == CharClass::Word || ccPrev == CharClass::Punctuation) && ccPrev != classify(data[pos]);
+    }
+
+    return true;
+}
+
+static bool isWordAt(const char *data, qint64 length, qint64 start, qint64 end)
+{
+    return start < end && isWordStartAt(data, length, start) && isWordEndAt(data, length, end);
+}
+
+// How many bytes the UTF-16 text takes up as UTF-8. Surrogates count as 2 each since a pair of them is 4.
+static qint64 utf8Length(const QChar *begin, const QChar *end)
+{
+    qint64 length = 0;
+
+    for (const QChar *c = begin; c < end; ++c) {
+        const ushort u = c->unicode();
+        length += u < 0x80 ? 1 : (u < 0x800 || c->isSurrogate()) ? 2 : 3;
+    }
+
+    return length;
+}
+
+static QString lineText(const char *data, qint64 length, qint64 lineStart)
+{
+    const qint64 maxEnd = qMin(length, lineStart + MAX_LINE_TEXT);
+    qint64 lineEnd = lineStart;
+
+    while (lineEnd < maxEnd && data[lineEnd] != '\r' && data[lineEnd] != '\n') {
+        lineEnd++;
+    }
+
+    // Don't cut a character in half if the line is too long
+    if (lineEnd == maxEnd && lineEnd < length) {
+        while (lineEnd > lineStart && (data[lineEnd] & 0xC0) == 0x80) {
+            lineEnd--;
+        }
+    }
+
+    return QString::fromUtf8(data + lineStart, static_cast<int>(lineEnd - lineStart));
+}
+
+
+TextSearcher::TextSearcher(const QString &text, int searchFlags) :
+    useRegex(searchFlags & SCFIND_REGEXP),
+    matchCase(searchFlags & SCFIND_MATCHCASE),
+    // Scintilla ignores it for regular expressions as well
+    wholeWord((searchFlags & SCFIND_WHOLEWORD) && !useRegex)
+{
+    QString pattern = text;
+
+    // Folding the case a byte at a time only works for ASCII, anything else needs the regex engine to do it
+    if (!useRegex && !matchCase && std::any_of(text.cbegin(), text.cend(), [](QChar c) { return c.unicode() >= 0x80; })) {
+        pattern = QRegularExpression::escape(text);
+        useRegex = true;
+    }
+
+    if (useRegex) {
+        QRegularExpression::PatternOptions options = QRegularExpression::MultilineOption | QRegularExpression::UseUnicodePropertiesOption;
+
+        if (!matchCase)
+            options |= QRegularExpression::CaseInsensitiveOption;
+
+        regex = QRegularExpression(pattern, options);
+        regex.optimize();
+    }
+    else {
+        needle = text.toUtf8();
+    }
+}
+
+bool TextSearcher::isValid() const
+{
+    return useRegex ? regex.isValid() && !regex.pattern().isEmpty() : !needle.isEmpty();
+}
+
+bool TextSearcher::canSearch(qint64 length) const
+{
+    return !useRegex || length <= INT_MAX;
+}
+
+QVector<LineMatches> TextSearcher::findAll(const char *data, qint64 length, const std::atomic<bool> &cancelled) const
+{
+    QVector<LineMatches> lines;
+
+    // Matches come in order, so the lines only need counted up to each one as it is found
+    qint64 lineNumber = 0;
+    qint64 lineStart = 0;
+    qint64 scanned = 0;
+
+    const auto found = [&](qint64 start, qint64 end) {
+        for (; scanned < start; ++scanned) {
+            const char c = data[scanned];
+
+            if (c == '\n' || (c == '\r' && (scanned + 1 == length || data[scanned + 1] != '\n'))) {
+                lineNumber++;
+                lineStart = scanned + 1;
+            }
+        }
+
+        if (lines.isEmpty() || lines.last().lineNumber != lineNumber) {
+            lines.append(LineMatches{lineText(data, length, lineStart), lineNumber, {}});
+        }
+
+        lines.last().ranges.append({start - lineStart, end - lineStart});
+    };
+
+    if (isValid()) {
+        if (useRegex)
+            findRegex(data, length, cancelled, found);
+        else
+            findLiteral(data, length, cancelled, found);
+    }
+
+    return lines;
+}
+
+void TextSearcher::findLiteral(const char *data, qint64 length, const std::atomic<bool> &cancelled, const std::function<void(qint64, qint64)> &found) const
+{
+    const char *end = data + length;
+
+    const auto search = [&](const auto &searcher) {
+        const char *from = data;
+
+        while (!cancelled) {
+            const char *match = std::search(from, end, searcher);
+
+            if (match == end)
+                break;
+
+            const qint64 start = match - data;
+            const qint64 stop = start + needle.size();
+
+            if (!wholeWord || isWordAt(data, length, start, stop)) {
+                found(start, stop);
+                from = data + stop;
+            }
+            else {
+                from = match + 1;
+            }
+        }
+    };
+
+    if (matchCase)
+        search(std::boyer_moore_horspool_searcher<const char *>(needle.constBegin(), needle.constEnd()));
+    else
+        search(std::boyer_moore_horspool_searcher<const char *, CaseInsensitiveHash, CaseInsensitiveEqual>(needle.constBegin(), needle.constEnd()));
+}
+
+void TextSearcher::findRegex(const char *data, qint64 length, const std::atomic<bool> &cancelled, const std::function<void(qint64, qint64)> &found) const
+{
+    // Callers are expected to have checked canSearch(), this is just so it never gets cut short without a word
+    if (!canSearch(length)) {
+        qWarning("Unable to search %lld bytes with a regular expression", length);
+        return;
+    }
+
+    // Anything that is not valid UTF-8 turns into a single U+FFFD, so offsets past it can be off by a few bytes
+    const QString view = QString::fromUtf8(data, static_cast<int>(length));
+
+    // Where the UTF-16 to UTF-8 conversion of offsets has got to
+    qint64 index = 0;
+    qint64 byte = 0;
+
+    const auto toByte = [&](qint64 target) {
+        byte += utf8Length(view.constData() + index, view.constData() + target);
+        index = target;
+        return byte;
+    };
+
+    QRegularExpressionMatchIterator it = regex.globalMatch(view);
+
+    while (it.hasNext() && !cancelled) {
+        const QRegularExpressionMatch match = it.next();
+
+        // Same as forEachMatch(), which has no way past an empty match either
+        if (match.capturedLength() == 0)
+            break;
+
+        const qint64 start = toByte(match.capturedStart());
+        const qint64 end = toByte(match.capturedEnd());
+
+        if (!wholeWord || isWordAt(data, length, start, end)) {
+            found(start, end);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TEXTSEARCHER_H
+#define TEXTSEARCHER_H
+
+#include <QByteArray>
+#include <QPair>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+
+static inline char toLowerAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+struct CaseInsensitiveHash
+{
+    size_t operator()(char c) const { return std::hash<char>()(toLowerAscii(c)); }
+};
+
+struct CaseInsensitiveEqual
+{
+    bool operator()(char a, char b) const { return toLowerAscii(a) == toLowerAscii(b); }
+};
+
+// The matches found on one line. Offsets are in bytes from the start of the line, same as the search results expect.
+struct LineMatches
+{
+    QString text; // Cut short if the line is very long
+    qint64 lineNumber;
+    QVector<QPair<qint64, qint64>> ranges;
+};
+
+// Finds every match of the text the same way Finder does for a document, but in a plain block of UTF-8 text
+// so that it can be done on any thread without a Scintilla document. Takes the same SCFIND_* flags.
+class TextSearcher
+{
+public:
+    TextSearcher(const QString &text, int searchFlags);
+
+    bool isValid() const;
+
+    // Regular expressions are matched against a QString, which can't hold text this long. Literal text can be any length.
+    bool canSearch(qint64 length) const;
+
+    // Stops early and returns what was found so far once cancelled is set
+    QVector<LineMatches> findAll(const char *data, qint64 length, const std::atomic<bool> &cancelled) const;
+
+private:
+    void findLiteral(const char *data, qint64 length, const std::atomic<bool> &cancelled, const std::function<void(qint64, qint64)> &found) const;
+    void findRegex(const char *data, qint64 length, const std::atomic<bool> &cancelled, const std::function<void(qint64, qint64)> &found) const;
+
+    QByteArray needle;
+    QRegularExpression regex;
+    bool useRegex = false;
+    bool matchCase = false;
+    bool wholeWord = false;
+};
+
+#endif // TEXTSEARCHER_H
@@ -0,0 +1,296 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Utf8Validator.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTF8VALIDATOR_SSE2
+#include <immintrin.h>
+#endif
+
+// AVX2 is used directly when the whole build targets it, otherwise GCC and Clang can compile just
+// the one function for it and pick it at runtime if the CPU supports it
+#if defined(__AVX2__)
+#define UTF8VALIDATOR_AVX2
+#elif defined(UTF8VALIDATOR_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define UTF8VALIDATOR_AVX2
+#define UTF8VALIDATOR_AVX2_DISPATCH
+#endif
+
+
+typedef qint64 (*AsciiPrefixFunction)(const unsigned char *data, qint64 length);
+
+// Returns how many bytes at the start of the data are ASCII
+static qint64 asciiPrefixScalar(const unsigned char *data, qint64 length)
+{
+    qint64 i = 0;
+
+    // Eight bytes at a time is still a lot better than one
+    for (; i + 8 <= length; i += 8) {
+        quint64 word;
+        memcpy(&word, data + i, sizeof(word));
+
+        if (word & Q_UINT64_C(0x8080808080808080)) {
+            break;
+        }
+    }
+
+    while (i < length && data[i] < 0x80) {
+        i++;
+    }
+
+    return i;
+}
+
+#if defined(UTF8VALIDATOR_SSE2)
+static qint64 asciiPrefixSse2(const unsigned char *data, qint64 length)
+{
+    qint64 i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+
+        // The high bit of every byte is collected into a mask, any bit set means a non-ASCII byte
+        if (_mm_movemask_epi8(chunk) != 0) {
+            break;
+        }
+    }
+
+    return i + asciiPrefixScalar(data + i, length - i);
+}
+#endif
+
+#if defined(UTF8VALIDATOR_AVX2)
+#if defined(UTF8VALIDATOR_AVX2_DISPATCH)
+__attribute__((target("avx2")))
+#endif
+static qint64 asciiPrefixAvx2(const unsigned char *data, qint64 length)
+{
+    qint64 i = 0;
+
+    for (; i + 64 <= length; i += 64) {
+        const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        const __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 32));
+
+        if (_mm256_movemask_epi8(_mm256_or_si256(first, second)) != 0) {
+            break;
+        }
+    }
+
+    for (; i + 32 <= length; i += 32) {
+        if (_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i))) != 0) {
+            break;
+        }
+    }
+
+    return i + asciiPrefixScalar(data + i, length - i);
+}
+#endif
+
+#if defined(UTF8VALIDATOR_AVX2_DISPATCH)
+static bool cpuSupportsAvx2()
+{
+    // This can run during static initialization, which may be before the CPU information is filled in
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+static AsciiPrefixFunction selectAsciiPrefix(const char **name)
+{
+#if defined(UTF8VALIDATOR_AVX2_DISPATCH)
+    if (cpuSupportsAvx2()) {
+        *name = "AVX2";
+        return asciiPrefixAvx2;
+    }
+#elif defined(UTF8VALIDATOR_AVX2)
+    *name = "AVX2";
+    return asciiPrefixAvx2;
+#endif
+
+#if defined(UTF8VALIDATOR_SSE2)
+    *name = "SSE2";
+    return asciiPrefixSse2;
+#else
+    *name = "scalar";
+    return asciiPrefixScalar;
+#endif
+}
+
+static const char *asciiPrefixName = "";
+static const AsciiPrefixFunction bestAsciiPrefix = selectAsciiPrefix(&asciiPrefixName);
+
+Utf8Validator::Utf8Validator(Implementation implementation)
+{
+    Q_ASSERT(isSupported(implementation));
+
+    switch (implementation) {
+    case Scalar:
+        asciiPrefix = asciiPrefixScalar;
+        break;
+#if defined(UTF8VALIDATOR_SSE2)
+    case Sse2:
+        asciiPrefix = asciiPrefixSse2;
+        break;
+#endif
+#if defined(UTF8VALIDATOR_AVX2)
+    case Avx2:
+        asciiPrefix = asciiPrefixAvx2;
+        break;
+#endif
+    default:
+        asciiPrefix = bestAsciiPrefix;
+        break;
+    }
+}
+
+bool Utf8Validator::validate(const char *data, qint64 length)
+{
+    if (!isValid()) {
+        return false;
+    }
+
+    const unsigned char *start = reinterpret_cast<const unsigned char *>(data);
+    const unsigned char *end = start + length;
+    const unsigned char *p = start;
+
+    while (p < end) {
+        if (continuationBytes == 0) {
+            if (*p < 0x80) {
+                p += asciiPrefix(p, end - p);
+
+                if (p == end) {
+                    break;
+                }
+            }
+
+            // The ranges come from the table of well-formed byte sequences in the Unicode standard
+            const unsigned char lead = *p;
+            sequenceStart = offset + (p - start);
+            ascii = false;
+            lowerBound = 0x80;
+            upperBound = 0xBF;
+
+            if (lead >= 0xC2 && lead <= 0xDF) {
+                continuationBytes = 1;
+            }
+            else if (lead == 0xE0) {
+                continuationBytes = 2;
+                lowerBound = 0xA0; // Overlong
+            }
+            else if ((lead >= 0xE1 && lead <= 0xEC) || lead == 0xEE || lead == 0xEF) {
+                continuationBytes = 2;
+            }
+            else if (lead == 0xED) {
+                continuationBytes = 2;
+                upperBound = 0x9F; // Surrogates
+            }
+            else if (lead == 0xF0) {
+                continuationBytes = 3;
+                lowerBound = 0x90; // Overlong
+            }
+            else if (lead >= 0xF1 && lead <= 0xF3) {
+                continuationBytes = 3;
+            }
+            else if (lead == 0xF4) {
+                continuationBytes = 3;
+                upperBound = 0x8F; // Past U+10FFFF
+            }
+            else {
+                break;
+            }
+
+            p++;
+        }
+
+        while (continuationBytes > 0 && p < end) {
+            if (*p < lowerBound || *p > upperBound) {
+                break;
+            }
+
+            lowerBound = 0x80;
+            upperBound = 0xBF;
+            continuationBytes--;
+            p++;
+        }
+
+        if (continuationBytes > 0 && p < end) {
+            break;
+        }
+    }
+
+    if (p < end) {
+        invalidOffset = sequenceStart;
+    }
+
+    offset += p - start;
+
+    return isValid();
+}
+
+bool Utf8Validator::finish()
+{
+    if (isValid() && continuationBytes > 0) {
+        invalidOffset = sequenceStart;
+    }
+
+    return isValid();
+}
+
+bool Utf8Validator::isValid(const char *data, qint64 length)
+{
+    Utf8Validator validator;
+
+    validator.validate(data, length);
+
+    return validator.finish();
+}
+
+const char *Utf8Validator::implementation()
+{
+    return asciiPrefixName;
+}
+
+bool Utf8Validator::isSupported(Implementation implementation)
+{
+    switch (implementation) {
+    case Best:
+    case Scalar:
+        return true;
+    case Sse2:
+#if defined(UTF8VALIDATOR_SSE2)
+        return true;
+#else
+        return false;
+#endif
+    case Avx2:
+#if defined(UTF8VALIDATOR_AVX2_DISPATCH)
+        return cpuSupportsAvx2();
+#elif defined(UTF8VALIDATOR_AVX2)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    return false;
+}
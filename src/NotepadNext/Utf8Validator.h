@@ -0,0 +1,79 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UTF8VALIDATOR_H
+#define UTF8VALIDATOR_H
+
+#include <QtGlobal>
+
+
+// Checks whether a stream of bytes is valid UTF-8 (no overlong forms, surrogates, or code points past
+// U+10FFFF). The data can be given in any number of chunks, even if they split a character in two.
+// Runs of ASCII are skipped with SIMD instructions where available, since that is what most text is.
+class Utf8Validator
+{
+public:
+    // Which instructions are used to skip ASCII. Only the best one the CPU supports gets used normally,
+    // the others are there to compare against.
+    enum Implementation {
+        Best,
+        Scalar,
+        Sse2,
+        Avx2,
+    };
+
+    explicit Utf8Validator(Implementation implementation = Best);
+
+    // Returns false as soon as the data is known to be invalid
+    bool validate(const char *data, qint64 length);
+
+    // Call once all of the data is given, since the last chunk may have ended part way into a character
+    bool finish();
+
+    bool isValid() const { return invalidOffset == -1; }
+    bool isAscii() const { return ascii; }
+
+    // Offset of the first byte that is not valid UTF-8, or -1 if everything was valid so far
+    qint64 firstInvalidOffset() const { return invalidOffset; }
+    qint64 bytesValidated() const { return offset; }
+
+    // Validates a complete buffer in one go
+    static bool isValid(const char *data, qint64 length);
+
+    // Name of the instruction set used to skip ASCII, e.g. "AVX2"
+    static const char *implementation();
+
+    // Whether this build and the CPU it is running on can use it
+    static bool isSupported(Implementation implementation);
+
+private:
+    qint64 (*asciiPrefix)(const unsigned char *data, qint64 length);
+
+    qint64 offset = 0;
+    qint64 invalidOffset = -1;
+    bool ascii = true;
+
+    // State of a character that is in progress
+    qint64 sequenceStart = 0;
+    int continuationBytes = 0;
+    unsigned char lowerBound = 0x80; // The byte right after the lead byte can have a narrower range
+    unsigned char upperBound = 0xBF;
+};
+
+#endif // UTF8VALIDATOR_H
@@ -25,16 +25,16 @@
 
 
 struct Selection {
-    int caret;
-    int anchor;
+    Sci_Position caret;
+    Sci_Position anchor;
 
-    Selection(int caret, int anchor) : caret(caret), anchor(anchor) {}
+    Selection(Sci_Position caret, Sci_Position anchor) : caret(caret), anchor(anchor) {}
 
-    int start() const { return qMin(caret, anchor); }
-    int end() const { return qMax(caret, anchor); }
-    int length() const { return end() - start(); }
-    void set(int pos) { anchor = caret = pos; }
-    void offset(int offset) { anchor += offset; caret += offset; }
+    Sci_Position start() const { return qMin(caret, anchor); }
+    Sci_Position end() const { return qMax(caret, anchor); }
+    Sci_Position length() const { return end() - start(); }
+    void set(Sci_Position pos) { anchor = caret = pos; }
+    void offset(Sci_Position offset) { anchor += offset; caret += offset; }
 };
 
 template<typename It>
@@ -125,7 +125,7 @@ bool BetterMultiSelection::eventFilter(QObject *obj, QEvent *event)
             }
             else {
                 if (keyEvent->key() == Qt::Key_Escape) {
-                    int caret = editor->selectionNCaret(editor->mainSelection());
+                    Sci_Position caret = editor->selectionNCaret(editor->mainSelection());
                     editor->setSelection(caret, caret);
                     return true;
                 }
@@ -183,8 +183,8 @@ QVector<Selection> BetterMultiSelection::GetSelections() {
 
     int num = editor->selections();
     for (int i = 0; i < num; ++i) {
-        int caret = editor->selectionNCaret(i);
-        int anchor = editor->selectionNAnchor(i);
+        Sci_Position caret = editor->selectionNCaret(i);
+        Sci_Position anchor = editor->selectionNAnchor(i);
         selections.append(Selection{ caret, anchor });
     }
 
@@ -211,10 +211,10 @@ void BetterMultiSelection::EditSelections(std::function<void(Selection &selectio
 
     editor->beginUndoAction();
 
-    int totalOffset = 0;
+    Sci_Position totalOffset = 0;
     for (auto &selection : selections) {
         selection.offset(totalOffset);
-        const int length = editor->length();
+        const Sci_Position length = editor->length();
 
         edit(selection);
 
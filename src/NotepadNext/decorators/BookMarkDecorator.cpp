@@ -78,11 +78,31 @@ void BookMarkDecorator::clearBookmarks()
     editor->markerDeleteAll(MARK_BOOKMARK);
 }
 
+QList<int> BookMarkDecorator::bookmarkedLines() const
+{
+    QList<int> lines;
+
+    for (int line = editor->markerNext(0, 1 << MARK_BOOKMARK); line != -1; line = editor->markerNext(line + 1, 1 << MARK_BOOKMARK)) {
+        lines.append(line);
+    }
+
+    return lines;
+}
+
+void BookMarkDecorator::setBookmarkedLines(const QList<int> &lines)
+{
+    clearBookmarks();
+
+    for (int line : lines) {
+        editor->markerAdd(line, MARK_BOOKMARK);
+    }
+}
+
 void BookMarkDecorator::notify(const Scintilla::NotificationData *pscn)
 {
     if (pscn->nmhdr.code == Scintilla::Notification::MarginClick) {
         if (pscn->margin == MARGIN) {
-            int line = editor->lineFromPosition(pscn->position);
+            Sci_Position line = editor->lineFromPosition(pscn->position);
             toggleBookmark(line);
         }
     }
@@ -34,6 +34,9 @@ public:
     int previousBookMarkBefore(int line);
     void clearBookmarks();
 
+    QList<int> bookmarkedLines() const;
+    void setBookmarkedLines(const QList<int> &lines);
+
 public slots:
     void notify(const Scintilla::NotificationData *pscn) override;
 };
@@ -71,6 +71,9 @@ void EditorConfigAppDecorator::doEditorConfig(ScintillaNext *editor)
 
             if (settings.contains(QStringLiteral("indent_size")) && settings[QStringLiteral("indent_size")].toInt() > 0) {
                 editor->setIndent(settings[QStringLiteral("indent_size")].toInt());
+
+                // Set a flag so that the indent size won't get overridden
+                editor->QObject::setProperty("nn_skip_indent", "EditorConfig");
             }
 
             if (settings.contains(QStringLiteral("tab_width")) && settings[QStringLiteral("tab_width")].toInt() > 0) {
@@ -84,6 +87,9 @@ void EditorConfigAppDecorator::doEditorConfig(ScintillaNext *editor)
                 if (settings[QStringLiteral("end_of_line")] == QStringLiteral("lf")) editor->setEOLMode(SC_EOL_LF);
                 else if (settings[QStringLiteral("end_of_line")] == QStringLiteral("cr")) editor->setEOLMode(SC_EOL_CR);
                 else if (settings[QStringLiteral("end_of_line")] == QStringLiteral("crlf")) editor->setEOLMode(SC_EOL_CRLF);
+
+                // Set a flag so that the line endings won't get overridden
+                editor->QObject::setProperty("nn_skip_eolmode", "EditorConfig");
             }
 
             if (settings.contains(QStringLiteral("trim_trailing_whitespace"))) {
@@ -120,8 +126,8 @@ void EditorConfigAppDecorator::ensureFinalNewline()
 {
     ScintillaNext *editor = qobject_cast<ScintillaNext *>(sender());
     const PreventUnfolding pu(editor);
-    const int lastLine = editor->lineCount() - 1;
-    const int lastLineLength = editor->lineEndPosition(lastLine) - editor->positionFromLine(lastLine);
+    const Sci_Position lastLine = editor->lineCount() - 1;
+    const Sci_Position lastLineLength = editor->lineEndPosition(lastLine) - editor->positionFromLine(lastLine);
 
     if (lastLineLength != 0) {
         switch (editor->eOLMode()) {
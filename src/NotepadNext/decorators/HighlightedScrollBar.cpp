@@ -74,7 +74,7 @@ void HighlightedScrollBar::paintEvent(QPaintEvent *event)
 void HighlightedScrollBar::drawMarker(QPainter &p, int marker)
 {
     // NOTE: SCI_MARKERGETBACK doesn't exist...so can't use the marker color
-    int curLine = 0;
+    Sci_Position curLine = 0;
 
     while ((curLine = editor->markerNext(curLine, 1 << marker)) != -1) {
         drawTickMark(p, lineToScrollBarY(curLine), DEFAULT_TICK_HEIGHT, QColor(100, 100, 255));
@@ -85,7 +85,7 @@ void HighlightedScrollBar::drawMarker(QPainter &p, int marker)
 
 void HighlightedScrollBar::drawIndicator(QPainter &p, int indicator)
 {
-    int curPos = editor->indicatorEnd(indicator, 0);
+    Sci_Position curPos = editor->indicatorEnd(indicator, 0);
     int color = editor->indicFore(indicator);
 
     if (curPos > 0) {
@@ -116,16 +116,16 @@ void HighlightedScrollBar::drawTickMark(QPainter &p, int y, int height, QColor c
     p.fillRect(rect().x() + DEFAULT_TICK_PADDING, y + scrollbarArrowHeight(), rect().width() - (DEFAULT_TICK_PADDING * 2), height, color);
 }
 
-int HighlightedScrollBar::posToScrollBarY(int pos) const
+int HighlightedScrollBar::posToScrollBarY(Sci_Position pos) const
 {
-    int line = editor->visibleFromDocLine(editor->lineFromPosition(pos));
+    const Sci_Position line = editor->visibleFromDocLine(editor->lineFromPosition(pos));
 
     return lineToScrollBarY(line);
 }
 
-int HighlightedScrollBar::lineToScrollBarY(int line) const
+int HighlightedScrollBar::lineToScrollBarY(Sci_Position line) const
 {
-    int lineCount = editor->visibleFromDocLine(editor->lineCount());
+    Sci_Position lineCount = editor->visibleFromDocLine(editor->lineCount());
 
     if (!editor->endAtLastLine()) {
         lineCount += editor->linesOnScreen();
@@ -61,8 +61,8 @@ private:
 
     void drawTickMark(QPainter &p, int y, int height, QColor color);
 
-    int posToScrollBarY(int pos) const;
-    int lineToScrollBarY(int line) const;
+    int posToScrollBarY(Sci_Position pos) const;
+    int lineToScrollBarY(Sci_Position line) const;
     int scrollbarArrowHeight() const;
 
     ScintillaNext *editor;
@@ -79,8 +79,8 @@ void SurroundSelection::surroundSelections(const char ch1, const char ch2)
 
     int num = editor->selections();
     for (int i = 0; i < num; ++i) {
-        int start = editor->selectionNStart(i);
-        int end = editor->selectionNEnd(i);
+        Sci_Position start = editor->selectionNStart(i);
+        Sci_Position end = editor->selectionNEnd(i);
 
         if (start != end /* && editor.LineFromPosition(start) == editor.LineFromPosition(end) */)
             selections.push_back(std::make_pair(start, end));
@@ -28,8 +28,8 @@ class URLFinder : public EditorDecorator
 
 public:
     URLFinder(ScintillaNext *editor);
-    bool isURL(int position) const;
-    void copyURLToClipboard(int position) const;
+    bool isURL(Sci_Position position) const;
+    void copyURLToClipboard(Sci_Position position) const;
 
 private slots:
     void findURLs();
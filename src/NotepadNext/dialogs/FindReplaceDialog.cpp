@@ -20,11 +20,18 @@
 #include "FindReplaceDialog.h"
 #include "ui_FindReplaceDialog.h"
 
+#include <QDir>
+#include <QFileDialog>
 #include <QSettings>
 #include <QStatusBar>
 #include <QLineEdit>
 #include <QKeyEvent>
+#include <QSharedPointer>
 
+#include "FindInFilesSearcher.h"
+#include "FolderAsWorkspaceDock.h"
+#include "OpenDocumentsSearcher.h"
+#include "PagedFileViewer.h"
 #include "ScintillaNext.h"
 #include "MainWindow.h"
 
@@ -43,7 +50,9 @@ FindReplaceDialog::FindReplaceDialog(ISearchResultsHandler *searchResults, MainW
     QDialog(window, Qt::Dialog),
     ui(new Ui::FindReplaceDialog),
     searchResultsHandler(searchResults),
-    finder(new Finder(window->currentEditor()))
+    finder(new Finder(window->currentEditor())),
+    filesSearcher(new FindInFilesSearcher(this)),
+    documentsSearcher(new OpenDocumentsSearcher(this))
 {
     qInfo(Q_FUNC_INFO);
 
@@ -59,6 +68,7 @@ FindReplaceDialog::FindReplaceDialog(ISearchResultsHandler *searchResults, MainW
     tabBar = new QTabBar();
     tabBar->addTab(tr("Find"));
     tabBar->addTab(tr("Replace"));
+    tabBar->addTab(tr("Find in Files"));
     tabBar->setExpanding(false);
     qobject_cast<QVBoxLayout *>(layout())->insertWidget(0, tabBar);
     connect(tabBar, &QTabBar::currentChanged, this, &FindReplaceDialog::changeTab);
@@ -70,6 +80,8 @@ FindReplaceDialog::FindReplaceDialog(ISearchResultsHandler *searchResults, MainW
     // Disable auto completion
     ui->comboFind->setCompleter(nullptr);
     ui->comboReplace->setCompleter(nullptr);
+    ui->comboFilters->setCompleter(nullptr);
+    ui->comboDirectory->setCompleter(nullptr);
 
     // If the selection changes highlight the text
     connect(ui->comboFind, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), ui->comboFind->lineEdit(), &QLineEdit::selectAll);
@@ -109,17 +121,7 @@ FindReplaceDialog::FindReplaceDialog(ISearchResultsHandler *searchResults, MainW
 
         close();
     });
-    connect(ui->buttonFindAllInDocuments, &QPushButton::clicked, this, [=]() {
-        prepareToPerformSearch();
-
-        searchResultsHandler->newSearch(findString());
-
-        findAllInDocuments();
-
-        searchResultsHandler->completeSearch();
-
-        close();
-    });
+    connect(ui->buttonFindAllInDocuments, &QPushButton::clicked, this, &FindReplaceDialog::findAllInDocuments);
     connect(ui->buttonReplace, &QPushButton::clicked, this, &FindReplaceDialog::replace);
     connect(ui->buttonReplaceAll, &QPushButton::clicked, this, &FindReplaceDialog::replaceAll);
     connect(ui->buttonReplaceAllInDocuments, &QPushButton::clicked, this, [=]() {
@@ -136,6 +138,10 @@ FindReplaceDialog::FindReplaceDialog(ISearchResultsHandler *searchResults, MainW
         MainWindow *window = qobject_cast<MainWindow *>(parent());
 
         for(ScintillaNext *editor : window->editors()) {
+            if (!editor->materialize()) {
+                continue;
+            }
+
             setEditor(editor);
             count += finder->replaceAll(replaceText);
         }
@@ -144,8 +150,54 @@ FindReplaceDialog::FindReplaceDialog(ISearchResultsHandler *searchResults, MainW
 
         showMessage(tr("Replaced %Ln matches", "", count), "green");
     });
+    connect(ui->buttonFindInFiles, &QPushButton::clicked, this, &FindReplaceDialog::findAllInFiles);
+    connect(ui->buttonCancelSearch, &QPushButton::clicked, filesSearcher, &FindInFilesSearcher::cancel);
+    connect(ui->buttonCancelSearch, &QPushButton::clicked, documentsSearcher, &OpenDocumentsSearcher::cancel);
+    connect(ui->buttonBrowseDirectory, &QToolButton::clicked, this, [=]() {
+        const QString dir = QFileDialog::getExistingDirectory(this, tr("Find in Files"), ui->comboDirectory->currentText(), QFileDialog::ShowDirsOnly);
+
+        if (!dir.isEmpty()) {
+            ui->comboDirectory->setCurrentText(QDir::toNativeSeparators(dir));
+        }
+    });
     connect(ui->buttonClose, &QPushButton::clicked, this, &FindReplaceDialog::close);
 
+    connect(filesSearcher, &FindInFilesSearcher::progress, this, [=](int filesSearched, int filesMatched) {
+        showMessage(tr("Searched %L1 files, found matches in %L2").arg(filesSearched).arg(filesMatched), "green");
+    });
+    connect(filesSearcher, &FindInFilesSearcher::finished, this, [=](bool cancelled) {
+        setSearchRunning(false);
+
+        if (cancelled) {
+            showMessage(tr("The search was cancelled."), "red");
+        }
+        else if (filesSearcher->skippedCount() > 0) {
+            // The progress message already says how many were searched, but the results would be missing these without a word
+            showMessage(tr("Skipped %Ln file(s) too big to search this way.", "", filesSearcher->skippedCount()), "red");
+        }
+    });
+
+    connect(documentsSearcher, &OpenDocumentsSearcher::progress, this, [=](int documentsSearched, int documentsMatched) {
+        Q_UNUSED(documentsMatched);
+        showMessage(tr("Searched %L1 of %L2 documents").arg(documentsSearched).arg(documentsSearcher->documentCount()), "green");
+    });
+    connect(documentsSearcher, &OpenDocumentsSearcher::finished, this, [=](bool cancelled) {
+        setSearchRunning(false);
+
+        if (cancelled) {
+            showMessage(tr("The search was cancelled."), "red");
+        }
+        else if (documentsSearcher->skippedCount() > 0) {
+            // Stay open so it doesn't look like everything was searched
+            showMessage(tr("Skipped %Ln document(s) too big to search this way.", "", documentsSearcher->skippedCount()), "red");
+        }
+        else {
+            close();
+        }
+    });
+
+    ui->buttonCancelSearch->hide();
+
     loadSettings();
 
     connect(qApp, &QApplication::aboutToQuit, this, &FindReplaceDialog::saveSettings);
@@ -194,6 +246,19 @@ void FindReplaceDialog::showEvent(QShowEvent *event)
     QDialog::showEvent(event);
 }
 
+// Hiding widgets in the form layout would leave gaps where they were, so they get squashed flat instead
+static void showFormWidgets(std::initializer_list<QWidget *> widgets, bool visible)
+{
+    for (QWidget *widget : widgets) {
+        widget->setMaximumHeight(visible ? QWIDGETSIZE_MAX : 0);
+
+        // The widget isn't actually "hidden", so adjust the focus policy so it does not get tabbed to
+        if (qobject_cast<QLabel *>(widget) == Q_NULLPTR) {
+            widget->setFocusPolicy(visible ? Qt::StrongFocus : Qt::NoFocus);
+        }
+    }
+}
+
 static void updateComboList(QComboBox *comboBox, const QString &text)
 {
     // Block the signals while it is manipulated
@@ -222,7 +287,13 @@ void FindReplaceDialog::find()
 
     prepareToPerformSearch();
 
-    Sci_CharacterRange range = finder->findNext();
+    // Only a window of the file is in the document, so look through the file itself
+    if (editor->isPaged() && !ui->radioRegexSearch->isChecked()) {
+        findInPagedFile();
+        return;
+    }
+
+    Sci_CharacterRangeFull range = finder->findNext();
 
     if (ScintillaNext::isRangeValid(range)) {
         if (finder->didLatestSearchWrapAround()) {
@@ -241,6 +312,41 @@ void FindReplaceDialog::find()
     }
 }
 
+void FindReplaceDialog::findInPagedFile()
+{
+    // The file is searched a block at a time from the current position onwards for the bytes as they are
+    if (ui->checkBoxMatchWholeWord->isChecked() || ui->checkBoxBackwardsDirection->isChecked()) {
+        showMessage(tr("Match whole word and backward direction are not supported for files this large."), "red");
+        return;
+    }
+
+    QString text = findString();
+
+    if (ui->radioExtendedSearch->isChecked()) {
+        convertToExtended(text);
+    }
+
+    PagedFileViewer *pager = editor->getPager();
+
+    // A search that got superseded never finishes, so whatever was waiting on it would pick up this one instead
+    disconnect(pagedFindConnection);
+
+    pagedFindConnection = connect(pager, &PagedFileViewer::findFinished, this, [=](qint64 offset) {
+        disconnect(pagedFindConnection);
+
+        if (offset == -1) {
+            showMessage(tr("No matches found."), "red");
+        }
+        else {
+            statusBar->clearMessage();
+        }
+    });
+
+    showMessage(tr("Searching the whole file..."), "green");
+
+    pager->find(text.toUtf8(), ui->checkBoxMatchCase->isChecked());
+}
+
 void FindReplaceDialog::findAllInCurrentDocument()
 {
     qInfo(Q_FUNC_INFO);
@@ -250,18 +356,18 @@ void FindReplaceDialog::findAllInCurrentDocument()
     QString text = findString();
 
     finder->setSearchText(text);
-    finder->forEachMatch([&](int start, int end){
+    finder->forEachMatch([&](Sci_Position start, Sci_Position end){
         // Only add the file entry if there was a valid search result
         if (firstMatch) {
             searchResultsHandler->newFileEntry(editor);
             firstMatch = false;
         }
 
-        const int line = editor->lineFromPosition(start);
-        const int lineStartPosition = editor->positionFromLine(line);
-        const int lineEndPosition = editor->lineEndPosition(line);
-        const int startPositionFromBeginning = start - lineStartPosition;
-        const int endPositionFromBeginning = end - lineStartPosition;
+        const Sci_Position line = editor->lineFromPosition(start);
+        const Sci_Position lineStartPosition = editor->positionFromLine(line);
+        const Sci_Position lineEndPosition = editor->lineEndPosition(line);
+        const Sci_Position startPositionFromBeginning = start - lineStartPosition;
+        const Sci_Position endPositionFromBeginning = end - lineStartPosition;
         QString lineText = editor->get_text_range(lineStartPosition, lineEndPosition);
 
         searchResultsHandler->newResultsEntry(lineText, line, startPositionFromBeginning, endPositionFromBeginning);
@@ -274,15 +380,96 @@ void FindReplaceDialog::findAllInDocuments()
 {
     qInfo(Q_FUNC_INFO);
 
-    ScintillaNext *current_editor = editor;
+    prepareToPerformSearch();
+
+    QString text = findString();
     MainWindow *window = qobject_cast<MainWindow *>(parent());
 
-    for(ScintillaNext *editor : window->editors()) {
-        setEditor(editor);
-        findAllInCurrentDocument();
+    if (ui->radioExtendedSearch->isChecked()) {
+        convertToExtended(text);
     }
 
-    setEditor(current_editor);
+    // Anything still going needs to hand over its last results before the next search shows up
+    documentsSearcher->stop();
+
+    searchResultsHandler->newSearch(findString());
+
+    // Only snapshots of the text are searched, so the editors don't need to be woken up or finish loading first
+    if (documentsSearcher->start(window->editors(), text, computeSearchFlags(), searchResultsHandler)) {
+        setSearchRunning(true);
+    }
+    else {
+        searchResultsHandler->completeSearch();
+    }
+}
+
+void FindReplaceDialog::findAllInFiles()
+{
+    qInfo(Q_FUNC_INFO);
+
+    prepareToPerformSearch();
+
+    QString text = findString();
+    const QString directory = ui->comboDirectory->currentText();
+    const QString filters = ui->comboFilters->currentText();
+
+    if (text.isEmpty()) {
+        return;
+    }
+
+    if (!QFileInfo(directory).isDir()) {
+        showMessage(tr("The directory does not exist."), "red");
+        return;
+    }
+
+    updateComboList(ui->comboDirectory, directory);
+    if (!filters.isEmpty())
+        updateComboList(ui->comboFilters, filters);
+
+    if (ui->radioExtendedSearch->isChecked()) {
+        convertToExtended(text);
+    }
+
+    // Anything still going needs to hand over its last results before the next search shows up
+    filesSearcher->stop();
+
+    filesSearcher->setFilters(filters);
+    filesSearcher->setSearchSubfolders(ui->checkBoxSubfolders->isChecked());
+    filesSearcher->setSearchHiddenFolders(ui->checkBoxHiddenFolders->isChecked());
+
+    searchResultsHandler->newSearch(findString());
+
+    // The results show up as they are found, and the searcher completes the search once it is done
+    if (filesSearcher->start(QDir::cleanPath(QFileInfo(directory).absoluteFilePath()), text, computeSearchFlags(), searchResultsHandler)) {
+        setSearchRunning(true);
+        showMessage(tr("Searching..."), "green");
+    }
+    else {
+        searchResultsHandler->completeSearch();
+        showMessage(tr("Invalid regular expression."), "red");
+    }
+}
+
+void FindReplaceDialog::setSearchRunning(bool running)
+{
+    ui->buttonFindInFiles->setEnabled(!running);
+    ui->buttonFindAllInDocuments->setEnabled(!running);
+    ui->buttonCancelSearch->setVisible(running);
+}
+
+QString FindReplaceDialog::defaultDirectory() const
+{
+    const MainWindow *window = qobject_cast<MainWindow *>(parent());
+    const FolderAsWorkspaceDock *fawDock = window->findChild<FolderAsWorkspaceDock *>();
+
+    if (fawDock && !fawDock->rootPath().isEmpty()) {
+        return QDir::toNativeSeparators(fawDock->rootPath());
+    }
+    else if (editor->isFile()) {
+        return QDir::toNativeSeparators(editor->getPath());
+    }
+
+    return QString();
 }
 
 void FindReplaceDialog::replace()
@@ -297,13 +484,13 @@ void FindReplaceDialog::replace()
         convertToExtended(replaceText);
     }
 
-    Sci_CharacterRange range = finder->replaceSelectionIfMatch(replaceText);
+    Sci_CharacterRangeFull range = finder->replaceSelectionIfMatch(replaceText);
 
     if (ScintillaNext::isRangeValid(range)) {
         showMessage(tr("1 occurrence was replaced"), "blue");
     }
 
-    Sci_CharacterRange next_match = finder->findNext();
+    Sci_CharacterRangeFull next_match = finder->findNext();
 
     if (ScintillaNext::isRangeValid(next_match)) {
         editor->goToRange(next_match);
@@ -351,6 +538,11 @@ void FindReplaceDialog::setEditor(ScintillaNext *editor)
 
 void FindReplaceDialog::performLastSearch()
 {
+    if (editor->isPaged() && !ui->radioRegexSearch->isChecked()) {
+        findInPagedFile();
+        return;
+    }
+
     editor->goToRange(finder->findNext());
 }
 
@@ -416,32 +608,30 @@ void FindReplaceDialog::adjustOpacityAlways(bool checked)
 
 void FindReplaceDialog::changeTab(int index)
 {
-    if (index == 0) {
-        ui->labelReplaceWith->setMaximumHeight(0);
-        ui->comboReplace->setMaximumHeight(0);
-        // The combo box isn't actually "hidden", so adjust the focus policy so it does not get tabbed to
-        ui->comboReplace->setFocusPolicy(Qt::NoFocus);
+    const bool isFind = index == FIND_TAB;
+    const bool isReplace = index == REPLACE_TAB;
+    const bool isFindInFiles = index == FIND_IN_FILES_TAB;
 
-        ui->buttonReplace->hide();
-        ui->buttonReplaceAll->hide();
-        ui->buttonReplaceAllInDocuments->hide();
+    showFormWidgets({ui->labelReplaceWith, ui->comboReplace}, isReplace);
+    showFormWidgets({ui->labelFilters, ui->comboFilters, ui->labelDirectory, ui->comboDirectory, ui->buttonBrowseDirectory,
+                     ui->checkBoxSubfolders, ui->checkBoxHiddenFolders}, isFindInFiles);
 
-        ui->buttonCount->show();
-        ui->buttonFindAllInCurrent->show();
-        ui->buttonFindAllInDocuments->show();
-    }
-    else if (index == 1) {
-        ui->labelReplaceWith->setMaximumHeight(QWIDGETSIZE_MAX);
-        ui->comboReplace->setMaximumHeight(QWIDGETSIZE_MAX);
-        ui->comboReplace->setFocusPolicy(Qt::StrongFocus); // Reset its focus policy
+    ui->buttonFind->setVisible(!isFindInFiles);
+    ui->buttonFind->setDefault(!isFindInFiles);
+
+    ui->buttonReplace->setVisible(isReplace);
+    ui->buttonReplaceAll->setVisible(isReplace);
+    ui->buttonReplaceAllInDocuments->setVisible(isReplace);
+
+    ui->buttonCount->setVisible(isFind);
+    ui->buttonFindAllInCurrent->setVisible(isFind);
+    ui->buttonFindAllInDocuments->setVisible(isFind);
 
-        ui->buttonReplace->show();
-        ui->buttonReplaceAll->show();
-        ui->buttonReplaceAllInDocuments->show();
+    ui->buttonFindInFiles->setVisible(isFindInFiles);
+    ui->buttonFindInFiles->setDefault(isFindInFiles);
 
-        ui->buttonCount->hide();
-        ui->buttonFindAllInCurrent->hide();
-        ui->buttonFindAllInDocuments->hide();
+    if (isFindInFiles && ui->comboDirectory->currentText().isEmpty()) {
+        ui->comboDirectory->setCurrentText(defaultDirectory());
     }
 
     ui->comboFind->setFocus();
@@ -497,11 +687,15 @@ void FindReplaceDialog::loadSettings()
 
     ui->comboFind->addItems(settings.value("RecentSearchList").toStringList());
     ui->comboReplace->addItems(settings.value("RecentReplaceList").toStringList());
+    ui->comboFilters->addItems(settings.value("RecentFiltersList").toStringList());
+    ui->comboDirectory->addItems(settings.value("RecentDirectoryList").toStringList());
 
     ui->checkBoxBackwardsDirection->setChecked(settings.value("Backwards").toBool());
     ui->checkBoxMatchWholeWord->setChecked(settings.value("WholeWord").toBool());
     ui->checkBoxMatchCase->setChecked(settings.value("MatchCase").toBool());
     ui->checkBoxWrapAround->setChecked(settings.value("WrapAround", true).toBool());
+    ui->checkBoxSubfolders->setChecked(settings.value("InSubfolders", true).toBool());
+    ui->checkBoxHiddenFolders->setChecked(settings.value("InHiddenFolders").toBool());
 
     if (settings.contains("SearchMode")) {
         const QString searchMode = settings.value("SearchMode").toString();
@@ -550,10 +744,24 @@ void FindReplaceDialog::saveSettings()
     }
     settings.setValue("RecentReplaceList", recentSearches);
 
+    recentSearches.clear();
+    for (int i = 0; i < ui->comboFilters->count(); ++i) {
+        recentSearches << ui->comboFilters->itemText(i);
+    }
+    settings.setValue("RecentFiltersList", recentSearches);
+
+    recentSearches.clear();
+    for (int i = 0; i < ui->comboDirectory->count(); ++i) {
+        recentSearches << ui->comboDirectory->itemText(i);
+    }
+    settings.setValue("RecentDirectoryList", recentSearches);
+
     settings.setValue("Backwards", ui->checkBoxBackwardsDirection->isChecked());
     settings.setValue("WholeWord", ui->checkBoxMatchWholeWord->isChecked());
     settings.setValue("MatchCase", ui->checkBoxMatchCase->isChecked());
     settings.setValue("WrapAround", ui->checkBoxWrapAround->isChecked());
+    settings.setValue("InSubfolders", ui->checkBoxSubfolders->isChecked());
+    settings.setValue("InHiddenFolders", ui->checkBoxHiddenFolders->isChecked());
 
     if (ui->radioNormalSearch->isChecked())
         settings.setValue("SearchMode", "normal");
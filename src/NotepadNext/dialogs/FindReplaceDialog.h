@@ -29,6 +29,8 @@
 #include "ISearchResultsHandler.h"
 
 
+class FindInFilesSearcher;
+class OpenDocumentsSearcher;
 class ScintillaNext;
 class MainWindow;
 
@@ -72,6 +74,7 @@ public slots:
     void find();
     void findAllInCurrentDocument();
     void findAllInDocuments();
+    void findAllInFiles();
     void count();
     void replace();
     void replaceAll();
@@ -88,6 +91,9 @@ private slots:
 private:
     QString findString();
     void prepareToPerformSearch(bool replace=false);
+    void findInPagedFile();
+    void setSearchRunning(bool running);
+    QString defaultDirectory() const;
     void loadSettings();
     void saveSettings();
 
@@ -111,6 +117,9 @@ private:
 
     ISearchResultsHandler *searchResultsHandler;
     Finder *finder;
+    FindInFilesSearcher *filesSearcher;
+    OpenDocumentsSearcher *documentsSearcher;
+    QMetaObject::Connection pagedFindConnection; // Until the paged file search it is waiting on is finished
 };
 
 #endif // FINDREPLACEDIALOG_H
@@ -39,6 +39,7 @@
 #include <QDirIterator>
 #include <QProcess>
 #include <QScreen>
+#include <QSharedPointer>
 
 
 #ifdef Q_OS_WIN
@@ -56,6 +57,8 @@
 #include "RecentFilesListManager.h"
 #include "RecentFilesListMenuBuilder.h"
 #include "EditorManager.h"
+#include "FileWatcher.h"
+#include "PagedFileViewer.h"
 
 #include "LuaConsoleDock.h"
 #include "LanguageInspectorDock.h"
@@ -104,6 +107,8 @@ MainWindow::MainWindow(NotepadNextApplication *app) :
     connect(dockedEditor, &DockedEditor::contextMenuRequestedForEditor, this, &MainWindow::tabBarRightClicked);
     connect(dockedEditor, &DockedEditor::titleBarDoubleClicked, this, &MainWindow::newFile);
 
+    connect(app->getFileWatcher(), &FileWatcher::fileStateChanged, this, &MainWindow::fileStateChanged);
+
     // Set up the menus
     connect(ui->actionNew, &QAction::triggered, this, &MainWindow::newFile);
     connect(ui->actionOpen, &QAction::triggered, this, &MainWindow::openFileDialog);
@@ -302,20 +307,53 @@ MainWindow::MainWindow(NotepadNextApplication *app) :
     srDock->toggleViewAction()->setShortcut(Qt::Key_F7);
     ui->menuView->addAction(srDock->toggleViewAction());
 
-    connect(srDock, &SearchResultsDock::searchResultActivated, this, [=](ScintillaNext *editor, int lineNumber, int startPositionFromBeginning, int endPositionFromBeginning) {
-        dockedEditor->switchToEditor(editor);
-
-        int linePos = editor->positionFromLine(lineNumber);
+    auto showSearchResult = [=](ScintillaNext *editor, Sci_Position lineNumber, Sci_Position startPositionFromBeginning, Sci_Position endPositionFromBeginning) {
+        const Sci_Position linePos = editor->positionFromLine(lineNumber);
         editor->goToRange({linePos + startPositionFromBeginning, linePos + endPositionFromBeginning});
         editor->verticalCentreCaret();
 
         editor->grabFocus();
+    };
+
+    auto goToSearchResult = [=](ScintillaNext *editor, Sci_Position lineNumber, Sci_Position startPositionFromBeginning, Sci_Position endPositionFromBeginning) {
+        dockedEditor->switchToEditor(editor);
+
+        if (editor->isLoading()) {
+            // Big files are read in the background, so the lines aren't there to go to yet
+            auto connection = QSharedPointer<QMetaObject::Connection>::create();
+
+            *connection = connect(editor, &ScintillaNext::loadFinished, this, [=](bool success) {
+                disconnect(*connection);
+
+                if (success) {
+                    showSearchResult(editor, lineNumber, startPositionFromBeginning, endPositionFromBeginning);
+                }
+            });
+        }
+        else {
+            showSearchResult(editor, lineNumber, startPositionFromBeginning, endPositionFromBeginning);
+        }
+    };
+
+    connect(srDock, &SearchResultsDock::searchResultActivated, this, goToSearchResult);
+    connect(srDock, &SearchResultsDock::searchResultInFileActivated, this, [=](const QString &filePath, Sci_Position lineNumber, Sci_Position startPositionFromBeginning, Sci_Position endPositionFromBeginning) {
+        openFile(filePath);
+
+        ScintillaNext *editor = app->getEditorManager()->getEditorByFilePath(filePath);
+
+        if (editor) {
+            goToSearchResult(editor, lineNumber, startPositionFromBeginning, endPositionFromBeginning);
+        }
     });
 
     connect(ui->actionFind, &QAction::triggered, this, [=]() {
         showFindReplaceDialog(FindReplaceDialog::FIND_TAB);
     });
 
+    connect(ui->actionFindInFiles, &QAction::triggered, this, [=]() {
+        showFindReplaceDialog(FindReplaceDialog::FIND_IN_FILES_TAB);
+    });
+
     connect(ui->actionFindNext, &QAction::triggered, this, [=]() {
         FindReplaceDialog *f = findChild<FindReplaceDialog *>(QString(), Qt::FindDirectChildrenOnly);
 
@@ -342,6 +380,24 @@ MainWindow::MainWindow(NotepadNextApplication *app) :
 
     connect(ui->actionGoToLine, &QAction::triggered, this, [=]() {
         ScintillaNext *editor = currentEditor();
+
+        // Only the lines that have been indexed so far can be gone to, and there can be more than fit in an int
+        if (editor->isPaged()) {
+            PagedFileViewer *pager = editor->getPager();
+            const qint64 maxLine = pager->indexedLineCount();
+            const QString label = pager->isIndexed() ? tr("Line Number (1 - %1)").arg(maxLine) : tr("Line Number (1 - %1, still indexing)").arg(maxLine);
+            bool ok;
+
+            const QString text = QInputDialog::getText(this, tr("Go to line"), label, QLineEdit::Normal, QString(), &ok);
+            const qint64 lineToGoTo = text.toLongLong(&ok);
+
+            if (ok && !pager->goToLine(lineToGoTo - 1)) {
+                ui->statusBar->showMessage(tr("Line %1 has not been indexed yet").arg(lineToGoTo), 3000);
+            }
+
+            return;
+        }
+
         const int currentLine = editor->lineFromPosition(editor->currentPos()) + 1;
         const int maxLine = editor->lineCount();
         bool ok;
@@ -357,6 +413,27 @@ MainWindow::MainWindow(NotepadNextApplication *app) :
         }
     });
 
+    connect(ui->actionGoToOffset, &QAction::triggered, this, [=]() {
+        ScintillaNext *editor = currentEditor();
+        const qint64 maxOffset = editor->isPaged() ? editor->getPager()->fileSize() : editor->length();
+        const qint64 currentOffset = editor->isPaged() ? editor->getPager()->windowStart() + editor->currentPos() : editor->currentPos();
+        bool ok;
+
+        const QString text = QInputDialog::getText(this, tr("Go to offset"), tr("Byte Offset (0 - %1)").arg(maxOffset), QLineEdit::Normal, QString::number(currentOffset), &ok);
+        const qint64 offset = qBound<qint64>(0, text.toLongLong(&ok), maxOffset);
+
+        if (ok) {
+            if (editor->isPaged()) {
+                editor->getPager()->goToOffset(offset);
+            }
+            else {
+                editor->ensureVisible(editor->lineFromPosition(offset));
+                editor->gotoPos(offset);
+                editor->verticalCentreCaret();
+            }
+        }
+    });
+
     connect(ui->actionToggleBookmark, &QAction::triggered, this, [=]() {
         ScintillaNext *editor = currentEditor();
         BookMarkDecorator *bookMarkDecorator = editor->findChild<BookMarkDecorator*>(QString(), Qt::FindDirectChildrenOnly);
@@ -508,6 +585,15 @@ MainWindow::MainWindow(NotepadNextApplication *app) :
         }
     });
 
+    connect(ui->actionFollowFile, &QAction::triggered, this, [=](bool b) {
+        ScintillaNext *editor = currentEditor();
+
+        if (!editor->setFollowing(b)) {
+            ui->actionFollowFile->setChecked(editor->isFollowing());
+            QMessageBox::information(this, tr("Follow File"), tr("Unable to follow <b>%1</b>. Make sure it has finished loading and has no unsaved changes.").arg(editor->getName()));
+        }
+    });
+
     // Zooming controls all editors simulaneously
     connect(ui->actionZoomIn, &QAction::triggered, this, [=]() {
         for (ScintillaNext *editor : editors()) {
@@ -853,6 +939,9 @@ void MainWindow::openFileList(const QStringList &fileNames)
     bool wasInitialState = isInInitialState();
     const ScintillaNext *mostRecentEditor = Q_NULLPTR;
 
+    // Reading several files one after another on the GUI thread adds up quickly, so read them all at once instead
+    const bool openInBackground = fileNames.size() > 1;
+
     for (const QString &filePath : fileNames) {
         qInfo("%s", qUtf8Printable(filePath));
 
@@ -876,6 +965,9 @@ void MainWindow::openFileList(const QStringList &fileNames)
                     continue;
                 }
             }
+            else if (openInBackground) {
+                editor = app->getEditorManager()->createEditorFromFileInBackground(filePath);
+            }
             else {
                 editor = app->getEditorManager()->createEditorFromFile(filePath);
             }
@@ -1101,14 +1193,20 @@ void MainWindow::closeAllToRight()
 
 bool MainWindow::saveCurrentFile()
 {
-    return saveFile(currentEditor());
+    return saveFile(currentEditor(), app->getSettings()->backgroundSave());
 }
 
-bool MainWindow::saveFile(ScintillaNext *editor)
+bool MainWindow::saveFile(ScintillaNext *editor, bool inBackground)
 {
     if (editor->isSavedToDisk())
         return true;
 
+    // Any error gets shown once it is done writing
+    if (inBackground && editor->isFile()) {
+        editor->saveInBackground();
+        return true;
+    }
+
     if (!editor->isFile()) {
         // Switch to the editor and show the saveas dialog
         dockedEditor->switchToEditor(editor);
@@ -1116,6 +1214,26 @@ bool MainWindow::saveFile(ScintillaNext *editor)
     }
     else {
         QFileDevice::FileError error = editor->save();
+
+        // An atomic save leaves the original untouched when it fails. If that is because no temporary file could be
+        // created next to it or renamed over it (e.g. the directory is read only), writing over the original may still
+        // work, but only if the user says so. Failing to write at all (e.g. the disk is full) would go no better.
+        const bool temporaryFileFailed = error == QFileDevice::OpenError || error == QFileDevice::RenameError;
+
+        if (temporaryFileFailed && editor->isAtomicSave()) {
+            const QString message = tr("<b>%1</b> could not be saved atomically.<br><br>Error: %2<br><br>Do you want to write over the file directly instead?").arg(editor->getFilePath(), qt_error_string(error));
+            auto reply = QMessageBox::question(this, tr("Save File"), message);
+
+            if (reply == QMessageBox::Yes) {
+                editor->setAtomicSave(false);
+                error = editor->save();
+                editor->setAtomicSave(true);
+            }
+            else {
+                return false;
+            }
+        }
+
         if (error == QFileDevice::NoError) {
             return true;
         }
@@ -1203,7 +1321,7 @@ bool MainWindow::saveCopyAs(const QString &fileName)
 void MainWindow::saveAll()
 {
     for (ScintillaNext *editor : editors()) {
-        saveFile(editor);
+        saveFile(editor, app->getSettings()->backgroundSave());
     }
 }
 
@@ -1345,16 +1463,16 @@ void MainWindow::showFindReplaceDialog(int index)
     // Get any selected text
     if (!editor->selectionEmpty()) {
         int selection = editor->mainSelection();
-        int start = editor->selectionNStart(selection);
-        int end = editor->selectionNEnd(selection);
+        Sci_Position start = editor->selectionNStart(selection);
+        Sci_Position end = editor->selectionNEnd(selection);
         if (end > start) {
             auto selText = editor->get_text_range(start, end);
             frd->setFindString(QString::fromUtf8(selText));
         }
     }
     else {
-        int start = editor->wordStartPosition(editor->currentPos(), true);
-        int end = editor->wordEndPosition(editor->currentPos(), true);
+        Sci_Position start = editor->wordStartPosition(editor->currentPos(), true);
+        Sci_Position end = editor->wordEndPosition(editor->currentPos(), true);
         if (end > start) {
             editor->setSelectionStart(start);
             editor->setSelectionEnd(end);
@@ -1391,6 +1509,8 @@ void MainWindow::updateFileStatusBasedUi(ScintillaNext *editor)
     ui->actionCopyFileDirectory->setEnabled(isFile);
     ui->actionShowInExplorer->setEnabled(isFile);
     ui->actionOpenCommandPromptHere->setEnabled(isFile);
+    ui->actionFollowFile->setEnabled(isFile);
+    ui->actionFollowFile->setChecked(editor->isFollowing());
 }
 
 bool MainWindow::isAnyUnsaved() const
@@ -1547,7 +1667,19 @@ void MainWindow::activateEditor(ScintillaNext *editor)
 {
     qInfo(Q_FUNC_INFO);
 
-    checkFileForModification(editor);
+    if (editor->isPlaceholder() || editor->isHibernated()) {
+        // The tab gets closed if the file can't be read
+        if (!editor->materialize()) {
+            return;
+        }
+
+        if (editor->isLoading()) {
+            ui->statusBar->trackLoadingEditor(editor);
+        }
+    }
+
+    // Only queues it up, the editor gets updated once the file has been looked at
+    app->getFileWatcher()->checkEditor(editor);
     updateGui(editor);
 
     emit editorActivated(editor);
@@ -1603,16 +1735,16 @@ void MainWindow::bringWindowToForeground()
 #endif
 }
 
-bool MainWindow::checkFileForModification(ScintillaNext *editor)
+void MainWindow::fileStateChanged(ScintillaNext *editor, ScintillaNext::FileStateChange state)
 {
     qInfo(Q_FUNC_INFO);
 
-    auto state = editor->checkFileForStateChange();
-
-    if (state == ScintillaNext::NoChange) {
-        return false;
+    // Every window hears about every editor, only the one it is in should act on it
+    if (!dockedEditor->contains(editor)) {
+        return;
     }
-    else if (state == ScintillaNext::Modified) {
+
+    if (state == ScintillaNext::Modified) {
         qInfo("ScintillaNext::Modified");
         editor->reload();
     }
@@ -1623,7 +1755,9 @@ bool MainWindow::checkFileForModification(ScintillaNext *editor)
         qInfo("ScintillaNext::Restored");
     }
 
-    return true;
+    if (editor == currentEditor()) {
+        updateGui(editor);
+    }
 }
 
 void MainWindow::showSaveErrorMessage(ScintillaNext *editor, QFileDevice::FileError error)
@@ -1682,7 +1816,10 @@ ISearchResultsHandler *MainWindow::determineSearchResultsHandler()
 {
     // Determine what will get the search results
     if (app->getSettings()->combineSearchResults()) {
-        searchResults.reset(new SearchResultsCollector(findChild<SearchResultsDock *>()));
+        // A search in files may still be handing results to it, so it has to stick around
+        if (searchResults.isNull()) {
+            searchResults.reset(new SearchResultsCollector(findChild<SearchResultsDock *>()));
+        }
 
         return searchResults.data();
     }
@@ -1716,16 +1853,18 @@ void MainWindow::focusIn()
 {
     qInfo(Q_FUNC_INFO);
 
-    if (checkFileForModification(currentEditor())) {
-        updateGui(currentEditor());
-    }
+    // Anything could have happened to the files while the application was in the background
+    app->getFileWatcher()->checkAll();
 }
 
 void MainWindow::addEditor(ScintillaNext *editor)
 {
     qInfo(Q_FUNC_INFO);
 
-    detectLanguage(editor);
+    // Placeholders have no text to look at yet, it gets detected once they are loaded
+    if (!editor->isPlaceholder()) {
+        detectLanguage(editor);
+    }
 
     // These should only ever occur for the focused editor??
     // TODO: look at editor inspector as an example to ensure updates are only coming from one editor.
@@ -1733,7 +1872,59 @@ void MainWindow::addEditor(ScintillaNext *editor)
     connect(editor, &ScintillaNext::savePointChanged, this, [=]() { updateSaveStatusBasedUi(editor); });
     connect(editor, &ScintillaNext::renamed, this, [=]() { detectLanguage(editor); });
     connect(editor, &ScintillaNext::renamed, this, [=]() { updateFileStatusBasedUi(editor); });
+    connect(editor, &ScintillaNext::followingChanged, this, [=]() {
+        if (editor == currentEditor()) {
+            updateFileStatusBasedUi(editor);
+        }
+    });
     connect(editor, &ScintillaNext::updateUi, this, &MainWindow::updateDocumentBasedUi);
+    connect(editor, &ScintillaNext::backgroundSaveFinished, this, [=](QFileDevice::FileError error) {
+        if (error != QFileDevice::NoError) {
+            showSaveErrorMessage(editor, error);
+        }
+    });
+
+    if (editor->isLoading() && !editor->isPlaceholder()) {
+        ui->statusBar->trackLoadingEditor(editor);
+    }
+
+    connect(editor, &ScintillaNext::awakened, this, [=]() { setLanguage(editor, editor->languageName); });
+
+    // What is left of the document is empty and read-only, so there is no point keeping the tab around
+    connect(editor, &ScintillaNext::loadFailed, this, [=](const QString &reason) {
+        const QString name = editor->isFile() ? editor->getFilePath() : editor->getName();
+        QMessageBox::warning(this, tr("Error Opening File"), tr("An error occurred when opening <b>%1</b><br><br>Error: %2").arg(name, reason));
+
+        editor->close();
+
+        // If the last document was closed, start with a new one
+        if (editorCount() == 0) {
+            newFile();
+        }
+    });
+
+    // A background load replaces the document, which also holds the lexer, so the language needs set up again
+    connect(editor, &ScintillaNext::loadFinished, this, [=](bool success) {
+        if (success) {
+            // Large files have no style storage so there is no point in running a lexer over them
+            if (editor->isLargeFile()) {
+                setLanguage(editor, QStringLiteral("Text"));
+            }
+            else if (editor->languageName.isEmpty() || editor->languageName == QStringLiteral("Text")) {
+                detectLanguage(editor);
+            }
+            else {
+                setLanguage(editor, editor->languageName);
+            }
+        }
+
+        if (editor == currentEditor()) {
+            updateGui(editor);
+
+            // The encoding is only known now that the file has been read
+            ui->statusBar->refresh(editor);
+        }
+    });
 
     // Watch for any zoom events (Ctrl+Scroll or pinch-to-zoom (Qt translates it as Ctrl+Scroll)) so that the event
     // can be handled before the ScintillaEditBase widget, so that it can be applied to all editors to keep zoom level equal.
@@ -76,7 +76,7 @@ public slots:
     void closeAllToRight();
 
     bool saveCurrentFile();
-    bool saveFile(ScintillaNext *editor);
+    bool saveFile(ScintillaNext *editor, bool inBackground=false);
 
     bool saveCurrentFileAsDialog();
     bool saveCurrentFileAs(const QString &fileName);
@@ -139,6 +139,7 @@ private slots:
     void languageMenuTriggered();
     void checkForUpdatesFinished(QString url);
     void activateEditor(ScintillaNext *editor);
+    void fileStateChanged(ScintillaNext *editor, ScintillaNext::FileStateChange state);
 
 private:
     Ui::MainWindow *ui = Q_NULLPTR;
@@ -151,7 +152,6 @@ private:
     bool isInInitialState();
     void openFileList(const QStringList &fileNames);
     bool checkEditorsBeforeClose(const QVector<ScintillaNext *> &editors);
-    bool checkFileForModification(ScintillaNext *editor);
     void showSaveErrorMessage(ScintillaNext *editor, QFileDevice::FileError error);
 
     void saveSettings() const;
@@ -167,7 +167,7 @@ private:
 
     ZoomEventWatcher *zoomEventWatcher;
     int zoomLevel = 0;
-    int contextMenuPos = 0;
+    Sci_Position contextMenuPos = 0;
 };
 
 #endif // MAINWINDOW_H
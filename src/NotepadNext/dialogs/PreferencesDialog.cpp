@@ -68,9 +68,44 @@ PreferencesDialog::PreferencesDialog(Settings *settings, QWidget *parent) :
     connect(settings, &Settings::restoreTempFilesChanged, ui->checkBoxRestoreTempFiles, &QCheckBox::setChecked);
     connect(ui->checkBoxRestoreTempFiles, &QCheckBox::toggled, settings, &Settings::setRestoreTempFiles);
 
+    ui->checkBoxRestoreFilesOnDemand->setChecked(settings->restoreFilesOnDemand());
+    connect(settings, &Settings::restoreFilesOnDemandChanged, ui->checkBoxRestoreFilesOnDemand, &QCheckBox::setChecked);
+    connect(ui->checkBoxRestoreFilesOnDemand, &QCheckBox::toggled, settings, &Settings::setRestoreFilesOnDemand);
+
+    ui->spinBoxSessionSnapshotInterval->setValue(settings->sessionSnapshotInterval());
+    connect(settings, &Settings::sessionSnapshotIntervalChanged, ui->spinBoxSessionSnapshotInterval, &QSpinBox::setValue);
+    connect(ui->spinBoxSessionSnapshotInterval, QOverload<int>::of(&QSpinBox::valueChanged), settings, &Settings::setSessionSnapshotInterval);
+
     ui->checkBoxCombineSearchResults->setChecked(settings->combineSearchResults());
     connect(settings, &Settings::combineSearchResultsChanged, ui->checkBoxCombineSearchResults, &QCheckBox::setChecked);
     connect(ui->checkBoxCombineSearchResults, &QCheckBox::toggled, settings, &Settings::setCombineSearchResults);
+
+    ui->checkBoxAtomicSave->setChecked(settings->atomicSave());
+    connect(settings, &Settings::atomicSaveChanged, ui->checkBoxAtomicSave, &QCheckBox::setChecked);
+    connect(ui->checkBoxAtomicSave, &QCheckBox::toggled, settings, &Settings::setAtomicSave);
+
+    ui->comboBoxSaveSyncMode->addItem(tr("Never"), static_cast<int>(FileWriter::NoSync));
+    ui->comboBoxSaveSyncMode->addItem(tr("File data"), static_cast<int>(FileWriter::DataSync));
+    ui->comboBoxSaveSyncMode->addItem(tr("File data, metadata and directory"), static_cast<int>(FileWriter::FullSync));
+    ui->comboBoxSaveSyncMode->setCurrentIndex(ui->comboBoxSaveSyncMode->findData(static_cast<int>(settings->saveSyncMode())));
+    connect(settings, &Settings::saveSyncModeChanged, ui->comboBoxSaveSyncMode, [=](FileWriter::SyncMode saveSyncMode) {
+        ui->comboBoxSaveSyncMode->setCurrentIndex(ui->comboBoxSaveSyncMode->findData(static_cast<int>(saveSyncMode)));
+    });
+    connect(ui->comboBoxSaveSyncMode, QOverload<int>::of(&QComboBox::currentIndexChanged), settings, [=](int index) {
+        settings->setSaveSyncMode(static_cast<FileWriter::SyncMode>(ui->comboBoxSaveSyncMode->itemData(index).toInt()));
+    });
+
+    ui->checkBoxBackgroundSave->setChecked(settings->backgroundSave());
+    connect(settings, &Settings::backgroundSaveChanged, ui->checkBoxBackgroundSave, &QCheckBox::setChecked);
+    connect(ui->checkBoxBackgroundSave, &QCheckBox::toggled, settings, &Settings::setBackgroundSave);
+
+    ui->spinBoxMaxConcurrentLoads->setValue(settings->maxConcurrentLoads());
+    connect(settings, &Settings::maxConcurrentLoadsChanged, ui->spinBoxMaxConcurrentLoads, &QSpinBox::setValue);
+    connect(ui->spinBoxMaxConcurrentLoads, QOverload<int>::of(&QSpinBox::valueChanged), settings, &Settings::setMaxConcurrentLoads);
+
+    ui->spinBoxHibernateAfter->setValue(settings->hibernateAfter());
+    connect(settings, &Settings::hibernateAfterChanged, ui->spinBoxHibernateAfter, &QSpinBox::setValue);
+    connect(ui->spinBoxHibernateAfter, QOverload<int>::of(&QSpinBox::valueChanged), settings, &Settings::setHibernateAfter);
 }
 
 PreferencesDialog::~PreferencesDialog()
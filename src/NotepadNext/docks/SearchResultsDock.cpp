@@ -30,7 +30,8 @@ enum SearchResultData
 {
     LineNumber = Qt::UserRole,
     LinePosStart,
-    LinePosEnd
+    LinePosEnd,
+    FilePath
 };
 
 SearchResultsDock::SearchResultsDock(QWidget *parent) :
@@ -105,27 +106,33 @@ void SearchResultsDock::newFileEntry(ScintillaNext *editor)
     totalFileHitCount = 0;
     currentFilePath = editor->isFile() ? editor->getFilePath() : editor->getName();
 
-    currentFile = new QTreeWidgetItem(currentSearch);
+    addFileItem();
     currentFile->setData(0, Qt::UserRole, QVariant::fromValue(editor_pointer));
 
-    currentFile->setBackground(0, QColor(213, 255, 213));
-    currentFile->setForeground(0, QColor(0, 128, 0));
-    currentFile->setExpanded(true);
-    currentFile->setFirstColumnSpanned(true);
+    updateSearchStatus();
+}
+
+void SearchResultsDock::newFileEntry(const QString filePath)
+{
+    totalFileHitCount = 0;
+    currentFilePath = filePath;
+
+    // There is no editor yet, it gets opened if one of the results is activated
+    addFileItem();
+    currentFile->setData(0, SearchResultData::FilePath, filePath);
 
-    currentFileCount++;
     updateSearchStatus();
 }
 
-void SearchResultsDock::newResultsEntry(const QString line, int lineNumber, int startPositionFromBeginning, int endPositionFromBeginning, int hitCount)
+void SearchResultsDock::newResultsEntry(const QString line, Sci_Position lineNumber, Sci_Position startPositionFromBeginning, Sci_Position endPositionFromBeginning, int hitCount)
 {
     QTreeWidgetItem *item = new QTreeWidgetItem(currentFile);
 
     // Scintilla internally references line numbers starting at 0, however it needs displayed starting at 1
     item->setText(0, QString::number(lineNumber + 1));
-    item->setData(0, SearchResultData::LineNumber, lineNumber);
-    item->setData(0, SearchResultData::LinePosStart, startPositionFromBeginning);
-    item->setData(0, SearchResultData::LinePosEnd, endPositionFromBeginning);
+    item->setData(0, SearchResultData::LineNumber, static_cast<qlonglong>(lineNumber));
+    item->setData(0, SearchResultData::LinePosStart, static_cast<qlonglong>(startPositionFromBeginning));
+    item->setData(0, SearchResultData::LinePosEnd, static_cast<qlonglong>(endPositionFromBeginning));
     item->setBackground(0, QBrush(QColor(220, 220, 220)));
     item->setTextAlignment(0, Qt::AlignRight);
 
@@ -186,15 +193,19 @@ void SearchResultsDock::itemActivated(QTreeWidgetItem *item, int column)
     // Make sure the entry has a parent since search entries can have no children
     if (item->childCount() == 0 && item->parent() != Q_NULLPTR) {
         QPointer<ScintillaNext> editor = item->parent()->data(0, Qt::UserRole).value<QPointer<ScintillaNext>>();
+        const QString filePath = item->parent()->data(0, SearchResultData::FilePath).toString();
+
+        Sci_Position lineNumber = item->data(0, SearchResultData::LineNumber).toLongLong();
+        Sci_Position startPositionFromBeginning = item->data(0, SearchResultData::LinePosStart).toLongLong();
+        Sci_Position endPositionFromBeginning = item->data(0, SearchResultData::LinePosEnd).toLongLong();
 
         // The editor may no longer exist
         if (editor) {
-            int lineNumber = item->data(0, SearchResultData::LineNumber).toInt();
-            int startPositionFromBeginning = item->data(0, SearchResultData::LinePosStart).toInt();
-            int endPositionFromBeginning = item->data(0, SearchResultData::LinePosEnd).toInt();
-
             emit searchResultActivated(editor, lineNumber, startPositionFromBeginning, endPositionFromBeginning);
         }
+        else if (!filePath.isEmpty()) {
+            emit searchResultInFileActivated(filePath, lineNumber, startPositionFromBeginning, endPositionFromBeginning);
+        }
     }
 }
 
@@ -203,6 +214,18 @@ void SearchResultsDock::itemExpanded(QTreeWidgetItem *)
     ui->treeWidget->resizeColumnToContents(1);
 }
 
+void SearchResultsDock::addFileItem()
+{
+    currentFile = new QTreeWidgetItem(currentSearch);
+
+    currentFile->setBackground(0, QColor(213, 255, 213));
+    currentFile->setForeground(0, QColor(0, 128, 0));
+    currentFile->setExpanded(true);
+    currentFile->setFirstColumnSpanned(true);
+
+    currentFileCount++;
+}
+
 void SearchResultsDock::updateSearchStatus()
 {
     currentSearch->setText(0, QStringLiteral("Search \"%1\" (%L2 hits in %L3 files)").arg(searchTerm).arg(totalHitCount).arg(currentFileCount));
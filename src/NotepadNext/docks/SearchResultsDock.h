@@ -41,7 +41,8 @@ public:
 
     void newSearch(const QString searchTerm) override;
     void newFileEntry(ScintillaNext *editor) override;
-    void newResultsEntry(const QString line, int lineNumber, int startPositionFromBeginning, int endPositionFromBeginning, int hitCount=1) override;
+    void newFileEntry(const QString filePath) override;
+    void newResultsEntry(const QString line, Sci_Position lineNumber, Sci_Position startPositionFromBeginning, Sci_Position endPositionFromBeginning, int hitCount=1) override;
     void completeSearch() override;
 
 public slots:
@@ -55,9 +56,11 @@ private slots:
     void itemExpanded(QTreeWidgetItem *item);
 
 signals:
-    void searchResultActivated(ScintillaNext *editor, int lineNumber, int startPositionFromBeginning, int endPositionFromBeginning);
+    void searchResultActivated(ScintillaNext *editor, Sci_Position lineNumber, Sci_Position startPositionFromBeginning, Sci_Position endPositionFromBeginning);
+    void searchResultInFileActivated(const QString &filePath, Sci_Position lineNumber, Sci_Position startPositionFromBeginning, Sci_Position endPositionFromBeginning);
 
 private:
+    void addFileItem();
     void updateSearchStatus();
     Ui::SearchResultsDock *ui;
 
@@ -21,6 +21,9 @@
 #include "MainWindow.h"
 #include "StatusLabel.h"
 
+#include <QProgressBar>
+#include <QTextCodec>
+
 
 EditorInfoStatusBar::EditorInfoStatusBar(QMainWindow *window) :
     QStatusBar(window)
@@ -41,6 +44,11 @@ EditorInfoStatusBar::EditorInfoStatusBar(QMainWindow *window) :
     unicodeType = new StatusLabel(125);
     addPermanentWidget(unicodeType, 0);
 
+    loadProgress = new QProgressBar();
+    loadProgress->setMaximumWidth(200);
+    loadProgress->setVisible(false);
+    addPermanentWidget(loadProgress, 0);
+
     /*
     docType->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(docType, &QLabel::customContextMenuRequested, [=](const QPoint &pos) {
@@ -107,9 +115,9 @@ void EditorInfoStatusBar::updateSelectionInfo(ScintillaNext *editor)
         selectionText = tr("Sel: N/A");
     }
     else {
-        int start = editor->selectionStart();
-        int end = editor->selectionEnd();
-        int lines = editor->lineFromPosition(end) - editor->lineFromPosition(start);
+        Sci_Position start = editor->selectionStart();
+        Sci_Position end = editor->selectionEnd();
+        Sci_Position lines = editor->lineFromPosition(end) - editor->lineFromPosition(start);
 
         if (end > start)
             lines++;
@@ -117,7 +125,7 @@ void EditorInfoStatusBar::updateSelectionInfo(ScintillaNext *editor)
         selectionText = tr("Sel: %L1 | %L2").arg(editor->countCharacters(start, end)).arg(lines);
     }
 
-    const int pos = editor->currentPos();
+    const Sci_Position pos = editor->currentPos();
     QString positionText = tr("Ln: %L1    Col: %L2    ").arg(editor->lineFromPosition(pos) + 1).arg(editor->column(pos) + 1);
     docPos->setText(positionText + selectionText);
 }
@@ -152,7 +160,21 @@ void EditorInfoStatusBar::updateEncoding(ScintillaNext *editor)
         unicodeType->setText(tr("ANSI"));
         break;
     case SC_CP_UTF8:
-        unicodeType->setText(tr("UTF-8"));
+        // The document is always UTF-8 internally, so show what the file is saved as
+        if (editor->isBinary()) {
+            // Any encoding found for it is meaningless, and this explains why it is read-only
+            unicodeType->setText(tr("Binary"));
+        }
+        else if (editor->getCodec()) {
+            unicodeType->setText(QString::fromLatin1(editor->getCodec()->name()));
+        }
+        else if (editor->firstInvalidUtf8Offset() != -1) {
+            // The bytes are kept as they are, but make it obvious something is off with the file
+            unicodeType->setText(tr("UTF-8 (invalid)"));
+        }
+        else {
+            unicodeType->setText(editor->hasBom() ? tr("UTF-8 BOM") : tr("UTF-8"));
+        }
         break;
     default:
         unicodeType->setText(QString::number(editor->codePage()));
@@ -160,3 +182,54 @@ void EditorInfoStatusBar::updateEncoding(ScintillaNext *editor)
     }
 }
 
+void EditorInfoStatusBar::trackLoadingEditor(ScintillaNext *editor)
+{
+    if (loadingEditors.contains(editor)) {
+        return;
+    }
+
+    loadingEditors.insert(editor, 0);
+
+    connect(editor, &ScintillaNext::loadProgress, this, [=](int percent) {
+        if (loadingEditors.contains(editor)) {
+            loadingEditors[editor] = percent;
+            updateLoadProgress();
+        }
+    });
+    connect(editor, &ScintillaNext::loadFinished, this, [=]() { loadingEditorDone(editor); });
+    connect(editor, &QObject::destroyed, this, [=]() { loadingEditorDone(editor); });
+
+    updateLoadProgress();
+}
+
+void EditorInfoStatusBar::loadingEditorDone(ScintillaNext *editor)
+{
+    if (loadingEditors.remove(editor) == 0) {
+        return;
+    }
+
+    finishedLoads++;
+    updateLoadProgress();
+}
+
+void EditorInfoStatusBar::updateLoadProgress()
+{
+    // Start counting again for the next batch once everything is done
+    if (loadingEditors.isEmpty()) {
+        finishedLoads = 0;
+        loadProgress->setVisible(false);
+        return;
+    }
+
+    int percent = finishedLoads * 100;
+    for (int editorPercent : qAsConst(loadingEditors)) {
+        percent += editorPercent;
+    }
+
+    const int total = finishedLoads + loadingEditors.size();
+
+    loadProgress->setRange(0, total * 100);
+    loadProgress->setValue(percent);
+    loadProgress->setFormat(tr("Opening %L1 of %L2 files").arg(finishedLoads + 1).arg(total));
+    loadProgress->setVisible(true);
+}
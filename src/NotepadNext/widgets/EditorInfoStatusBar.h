@@ -20,6 +20,7 @@
 #ifndef EDITORINFOSTATUSBAR_H
 #define EDITORINFOSTATUSBAR_H
 
+#include <QHash>
 #include <QStatusBar>
 
 #include "ScintillaTypes.h"
@@ -27,6 +28,7 @@
 
 class QLabel;
 class QMainWindow;
+class QProgressBar;
 class ScintillaNext;
 
 class EditorInfoStatusBar : public QStatusBar
@@ -38,6 +40,9 @@ public:
 
     void refresh(ScintillaNext *editor);
 
+    // Shows the progress of every file being read in the background as one batch
+    void trackLoadingEditor(ScintillaNext *editor);
+
 private slots:
     void connectToEditor(ScintillaNext *editor);
 
@@ -49,12 +54,19 @@ private slots:
     void updateEol(ScintillaNext *editor);
     void updateEncoding(ScintillaNext *editor);
 
+    void loadingEditorDone(ScintillaNext *editor);
+    void updateLoadProgress();
+
 private:
     QLabel *docType;
     QLabel *docSize;
     QLabel *docPos;
     QLabel *unicodeType;
     QLabel *eolFormat;
+    QProgressBar *loadProgress;
+
+    QHash<ScintillaNext *, int> loadingEditors; // The percent read of each file still loading
+    int finishedLoads = 0;
 
     QMetaObject::Connection editorUiUpdated;
     QMetaObject::Connection documentLexerChanged;
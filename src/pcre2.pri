@@ -0,0 +1,31 @@
+# This file is part of Notepad Next.
+# Copyright 2019 Justin Dailey
+#
+# Notepad Next is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Notepad Next is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+
+
+# Optionally match regular expressions with PCRE2 directly on the UTF-8 text instead of QRegularExpression,
+# e.g. "qmake CONFIG+=pcre2". Set PCRE2_DIR if PCRE2 can't be found with pkg-config.
+pcre2 {
+    DEFINES += USE_PCRE2_REGEX PCRE2_CODE_UNIT_WIDTH=8
+
+    isEmpty(PCRE2_DIR) {
+        CONFIG += link_pkgconfig
+        PKGCONFIG += libpcre2-8
+    }
+    else {
+        INCLUDEPATH += $$PCRE2_DIR/include
+        LIBS += -L$$PCRE2_DIR/lib -lpcre2-8
+    }
+}
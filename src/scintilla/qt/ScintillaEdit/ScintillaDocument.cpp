@@ -88,10 +88,10 @@ void WatcherHelper::NotifyErrorOccurred(Document *, void *, Status status) {
     emit owner->error_occurred(static_cast<int>(status));
 }
 
-ScintillaDocument::ScintillaDocument(QObject *parent, void *pdoc_) :
+ScintillaDocument::ScintillaDocument(QObject *parent, void *pdoc_, int documentOptions) :
     QObject(parent), pdoc(pdoc_), docWatcher(nullptr) {
     if (!pdoc) {
-	pdoc = new Document(DocumentOption::Default);
+	pdoc = new Document(static_cast<DocumentOption>(documentOptions));
     }
     docWatcher = new WatcherHelper(this);
     (static_cast<Document *>(pdoc))->AddRef();
@@ -31,7 +31,7 @@ class EXPORT_IMPORT_API ScintillaDocument : public QObject
     WatcherHelper *docWatcher;
 
 public:
-    explicit ScintillaDocument(QObject *parent = 0, void *pdoc_=0);
+    explicit ScintillaDocument(QObject *parent = 0, void *pdoc_=0, int documentOptions=0);
     virtual ~ScintillaDocument();
     void *pointer();
 
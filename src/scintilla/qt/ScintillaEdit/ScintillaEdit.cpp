@@ -4,6 +4,8 @@
 
 #include "ScintillaEdit.h"
 
+#include <climits>
+
 using namespace Scintilla;
 
 ScintillaEdit::ScintillaEdit(QWidget *parent) : ScintillaEditBase(parent) {
@@ -23,28 +25,34 @@ QByteArray ScintillaEdit::TextReturner(int message, uptr_t wParam) const {
     return ba;
 }
 
-QPair<int, int>ScintillaEdit::find_text(int flags, const char *text, int cpMin, int cpMax) {
-    struct Sci_TextToFind ft = {{0, 0}, 0, {0, 0}};
+QPair<sptr_t, sptr_t>ScintillaEdit::find_text(int flags, const char *text, sptr_t cpMin, sptr_t cpMax) {
+    struct Sci_TextToFindFull ft = {{0, 0}, 0, {0, 0}};
     ft.chrg.cpMin = cpMin;
     ft.chrg.cpMax = cpMax;
     ft.chrgText.cpMin = cpMin;
     ft.chrgText.cpMax = cpMax;
     ft.lpstrText = text;
 
-    int start = send(SCI_FINDTEXT, flags, (uptr_t) (&ft));
+    sptr_t start = send(SCI_FINDTEXTFULL, flags, (uptr_t) (&ft));
 
-    return QPair<int,int>(start, ft.chrgText.cpMax);
+    return QPair<sptr_t,sptr_t>(start, ft.chrgText.cpMax);
 }
 
-QByteArray ScintillaEdit::get_text_range(int start, int end) {
+QByteArray ScintillaEdit::get_text_range(sptr_t start, sptr_t end) {
     if (start > end)
         start = end;
 
-    int length = end-start;
+    // QByteArray uses int size (with room for the NUL) so the range itself has to fit
+    if (end - start >= INT_MAX) {
+        qWarning("get_text_range(%lld, %lld) is too big for a QByteArray", static_cast<long long>(start), static_cast<long long>(end));
+        return QByteArray();
+    }
+
+    int length = static_cast<int>(end-start);
     QByteArray ba(length+1, '\0');
-    struct Sci_TextRange tr = {{start, end}, ba.data()};
+    struct Sci_TextRangeFull tr = {{start, end}, ba.data()};
 
-    send(SCI_GETTEXTRANGE, 0, (sptr_t)&tr);
+    send(SCI_GETTEXTRANGEFULL, 0, (sptr_t)&tr);
     ba.chop(1); // Remove extra NUL
 
     return ba;
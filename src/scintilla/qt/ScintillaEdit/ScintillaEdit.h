@@ -33,17 +33,17 @@ public:
 
 	QByteArray TextReturner(int message, uptr_t wParam) const;
 
-	QPair<int, int>find_text(int flags, const char *text, int cpMin, int cpMax);
-	QByteArray get_text_range(int start, int end);
+	QPair<sptr_t, sptr_t>find_text(int flags, const char *text, sptr_t cpMin, sptr_t cpMax);
+	QByteArray get_text_range(sptr_t start, sptr_t end);
         ScintillaDocument *get_doc();
         void set_doc(ScintillaDocument *pdoc_);
 
 	// Same as previous two methods but with Qt style names
-	QPair<int, int>findText(int flags, const char *text, int cpMin, int cpMax) {
+	QPair<sptr_t, sptr_t>findText(int flags, const char *text, sptr_t cpMin, sptr_t cpMax) {
 		return find_text(flags, text, cpMin, cpMax);
 	}
 
-	QByteArray textRange(int start, int end) {
+	QByteArray textRange(sptr_t start, sptr_t end) {
 		return get_text_range(start, end);
 	}
 
@@ -26,6 +26,14 @@
 #include <regex>
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#define DOCUMENT_FIND_SSE2 1
+#endif
+
 #include "ScintillaTypes.h"
 #include "ILoader.h"
 #include "ILexer.h"
@@ -2067,24 +2075,6 @@ CharacterExtracted Document::ExtractCharacter(Sci::Position position) const noex
 
 namespace {
 
-// Equivalent of memchr over the split view
-ptrdiff_t SplitFindChar(const SplitView &view, size_t start, size_t length, int ch) noexcept {
-	size_t range1Length = 0;
-	if (start < view.length1) {
-		range1Length = std::min(length, view.length1 - start);
-		const char *match = static_cast<const char *>(memchr(view.segment1 + start, ch, range1Length));
-		if (match) {
-			return match - view.segment1;
-		}
-		start += range1Length;
-	}
-	const char *match2 = static_cast<const char *>(memchr(view.segment2 + start, ch, length - range1Length));
-	if (match2) {
-		return match2 - view.segment2;
-	}
-	return -1;
-}
-
 // Equivalent of memcmp over the split view
 // This does not call memcmp as search texts are commonly too short to overcome the
 // call overhead.
@@ -2097,6 +2087,139 @@ bool SplitMatch(const SplitView &view, size_t start, std::string_view text) noex
 	return true;
 }
 
+#if defined(DOCUMENT_FIND_SSE2)
+
+int LowestBitSet(unsigned int mask) noexcept {
+#if defined(_MSC_VER)
+	unsigned long index = 0;
+	_BitScanForward(&index, mask);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+#endif
+
+// Equivalent of memmem over contiguous text.
+// Candidates have to match both the first and the last byte of the needle. With SSE2 this is checked 16
+// positions at a time, which rules out nearly every position without looking at the rest of the needle.
+ptrdiff_t ContiguousFind(const char *text, size_t length, std::string_view needle) noexcept {
+	const size_t lenNeedle = needle.length();
+	if (lenNeedle > length) {
+		return -1;
+	}
+	const char chFirst = needle.front();
+	if (lenNeedle == 1) {
+		const char *match = static_cast<const char *>(memchr(text, chFirst, length));
+		return match ? match - text : -1;
+	}
+	const char chLast = needle.back();
+	const size_t lastStart = length - lenNeedle;
+	size_t pos = 0;
+#if defined(DOCUMENT_FIND_SSE2)
+	const __m128i firsts = _mm_set1_epi8(chFirst);
+	const __m128i lasts = _mm_set1_epi8(chLast);
+	for (; pos + 16 <= lastStart + 1; pos += 16) {
+		const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + pos));
+		const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + pos + lenNeedle - 1));
+		unsigned int mask = _mm_movemask_epi8(
+			_mm_and_si128(_mm_cmpeq_epi8(blockFirst, firsts), _mm_cmpeq_epi8(blockLast, lasts)));
+		while (mask) {
+			const size_t candidate = pos + LowestBitSet(mask);
+			if (memcmp(text + candidate + 1, needle.data() + 1, lenNeedle - 2) == 0) {
+				return candidate;
+			}
+			mask &= mask - 1;
+		}
+	}
+#endif
+	while (pos <= lastStart) {
+		const char *match = static_cast<const char *>(memchr(text + pos, chFirst, lastStart + 1 - pos));
+		if (!match) {
+			return -1;
+		}
+		pos = match - text;
+		if ((text[pos + lenNeedle - 1] == chLast) && (memcmp(text + pos + 1, needle.data() + 1, lenNeedle - 2) == 0)) {
+			return pos;
+		}
+		pos++;
+	}
+	return -1;
+}
+
+// Equivalent of memmem over the split view.
+// Returns the first position in [start, start + length) where the whole of text matches without going past
+// the end of the range. Positions where text would be divided by the gap are checked one by one.
+ptrdiff_t SplitFind(const SplitView &view, size_t start, size_t length, std::string_view text) noexcept {
+	const size_t end = start + length;
+	const size_t lenText = text.length();
+	if (start < view.length1) {
+		const size_t end1 = std::min(end, view.length1);
+		const ptrdiff_t match = ContiguousFind(view.segment1 + start, end1 - start, text);
+		if (match >= 0) {
+			return start + match;
+		}
+		const size_t startStraddle = (view.length1 >= lenText) ? view.length1 - lenText + 1 : 0;
+		for (size_t pos = std::max(start, startStraddle); (pos < view.length1) && (pos + lenText <= end); pos++) {
+			if (SplitMatch(view, pos, text)) {
+				return pos;
+			}
+		}
+		start = view.length1;
+	}
+	if (start < end) {
+		const ptrdiff_t match = ContiguousFind(view.segment2 + start, end - start, text);
+		if (match >= 0) {
+			return start + match;
+		}
+	}
+	return -1;
+}
+
+// Finds the first byte in contiguous text that is either ch1 or ch2 or is not ASCII
+ptrdiff_t ContiguousFindEitherOrNonAscii(const char *text, size_t length, char ch1, char ch2) noexcept {
+	size_t pos = 0;
+#if defined(DOCUMENT_FIND_SSE2)
+	const __m128i ch1s = _mm_set1_epi8(ch1);
+	const __m128i ch2s = _mm_set1_epi8(ch2);
+	for (; pos + 16 <= length; pos += 16) {
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + pos));
+		// Non-ASCII bytes already have their top bit set
+		const unsigned int mask = _mm_movemask_epi8(
+			_mm_or_si128(block, _mm_or_si128(_mm_cmpeq_epi8(block, ch1s), _mm_cmpeq_epi8(block, ch2s))));
+		if (mask) {
+			return pos + LowestBitSet(mask);
+		}
+	}
+#endif
+	for (; pos < length; pos++) {
+		const char ch = text[pos];
+		if ((ch == ch1) || (ch == ch2) || !UTF8IsAscii(ch)) {
+			return pos;
+		}
+	}
+	return -1;
+}
+
+// Equivalent of ContiguousFindEitherOrNonAscii over the split view
+ptrdiff_t SplitFindEitherOrNonAscii(const SplitView &view, size_t start, size_t length, char ch1, char ch2) noexcept {
+	size_t range1Length = 0;
+	if (start < view.length1) {
+		range1Length = std::min(length, view.length1 - start);
+		const ptrdiff_t match = ContiguousFindEitherOrNonAscii(view.segment1 + start, range1Length, ch1, ch2);
+		if (match >= 0) {
+			return start + match;
+		}
+		start += range1Length;
+	}
+	const ptrdiff_t match2 = ContiguousFindEitherOrNonAscii(view.segment2 + start, length - range1Length, ch1, ch2);
+	if (match2 >= 0) {
+		return start + match2;
+	}
+	return -1;
+}
+
 }
 
 /**
@@ -2141,15 +2264,15 @@ Sci::Position Document::FindText(Sci::Position minPos, Sci::Position maxPos, con
 			const unsigned char charStartSearch =  search[0];
 			if (forward && ((0 == dbcsCodePage) || (CpUtf8 == dbcsCodePage && !UTF8IsTrailByte(charStartSearch)))) {
 				// This is a fast case where there is no need to test byte values to iterate
-				// so becomes the equivalent of a memchr+memcmp loop.
+				// so becomes the equivalent of a memmem loop over each segment.
 				// UTF-8 search will not be self-synchronizing when starts with trail byte
-				const std::string_view suffix(search + 1, lengthFind - 1);
+				const std::string_view needle(search, lengthFind);
 				while (pos < endSearch) {
-					pos = SplitFindChar(cbView, pos, limitPos - pos, charStartSearch);
+					pos = SplitFind(cbView, pos, limitPos - pos, needle);
 					if (pos < 0) {
 						break;
 					}
-					if (SplitMatch(cbView, pos + 1, suffix) && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
+					if (MatchesWordOptions(word, wordStart, pos, lengthFind)) {
 						return pos;
 					}
 					pos++;
@@ -2185,7 +2308,18 @@ Sci::Position Document::FindText(Sci::Position minPos, Sci::Position maxPos, con
 			std::vector<char> searchThing((lengthFind+1) * UTF8MaxBytes * maxFoldingExpansion + 1);
 			const size_t lenSearch =
 				pcf->Fold(&searchThing[0], searchThing.size(), search, lengthFind);
+			// When the folded search starts with an ASCII character, skip quickly to the next byte that is
+			// that character in either case, or is not ASCII and so may fold to it. Other ASCII bytes can't match.
+			const char chFoldedFirst = searchThing[0];
+			const bool skipToCandidate = forward && (lenSearch > 0) && UTF8IsAscii(chFoldedFirst);
+			const char chCandidateUpper = MakeUpperCase(chFoldedFirst);
 			while (forward ? (pos < endPos) : (pos >= endPos)) {
+				if (skipToCandidate) {
+					pos = SplitFindEitherOrNonAscii(cbView, pos, endPos - pos, chFoldedFirst, chCandidateUpper);
+					if (pos < 0) {
+						break;
+					}
+				}
 				int widthFirstCharacter = 1;
 				Sci::Position posIndexDocument = pos;
 				size_t indexSearch = 0;
@@ -22,6 +22,7 @@
 
 #include "Debugging.h"
 
+#include "CharacterType.h"
 #include "CharacterCategoryMap.h"
 #include "Position.h"
 #include "SplitVector.h"
@@ -179,6 +180,53 @@ TEST_CASE("Document") {
 		}
 	}
 
+	SECTION("SearchLongInBothSegments") {
+		// Long enough for the search to go 16 bytes at a time, with matches on both sides of the gap and across it
+		std::string text;
+		for (int i = 0; i < 10; i++) {
+			text += "0123456789abcdefghij";
+		}
+		const std::string finding = "needle-in-a-haystack";
+		text += finding + std::string(40, '.') + finding;
+		DocPlus doc(text, CpUtf8);
+		const Sci::Position first = text.find(finding);
+		const Sci::Position second = text.find(finding, first + 1);
+		const std::string findingUpper = "NEEDLE-IN-A-HAYSTACK";
+		for (Sci::Position gapPos = 0; gapPos <= doc.document.Length(); gapPos++) {
+			doc.MoveGap(gapPos);
+			Sci::Position lengthFinding = finding.length();
+			Sci::Position location = doc.FindNeedle(finding, FindOption::MatchCase, &lengthFinding);
+			REQUIRE(location == first);
+			location = doc.document.FindText(first + 1, doc.document.Length(), finding.c_str(), FindOption::MatchCase, &lengthFinding);
+			REQUIRE(location == second);
+			// The match has to end inside the range
+			location = doc.document.FindText(first + 1, doc.document.Length() - 1, finding.c_str(), FindOption::MatchCase, &lengthFinding);
+			REQUIRE(location == -1);
+			location = doc.FindNeedle(findingUpper, FindOption::MatchCase, &lengthFinding);
+			REQUIRE(location == -1);
+			location = doc.FindNeedle(findingUpper, FindOption::None, &lengthFinding);
+			REQUIRE(location == first);
+			location = doc.document.FindText(first + 1, doc.document.Length(), findingUpper.c_str(), FindOption::None, &lengthFinding);
+			REQUIRE(location == second);
+		}
+	}
+
+	SECTION("InsensitiveSearchSkipsToNonASCII") {
+		// Skipping ahead to the next possible first byte must still stop at characters that fold to ASCII:
+		// U+212A KELVIN SIGN folds to k
+		std::string text = std::string(40, '-') + "\xCE\x93" + std::string(40, '-') + "\xE2\x84\xAA" "ey";
+		DocPlus doc(text, CpUtf8);
+		const Sci::Position kelvin = text.find("\xE2\x84\xAA");
+		const std::string finding = "KEY";
+		Sci::Position lengthFinding = finding.length();
+		Sci::Position location = doc.FindNeedle(finding, FindOption::None, &lengthFinding);
+		REQUIRE(location == kelvin);
+		REQUIRE(lengthFinding == 5);
+		lengthFinding = finding.length();
+		location = doc.FindNeedle(finding, FindOption::MatchCase, &lengthFinding);
+		REQUIRE(location == -1);
+	}
+
 	SECTION("InsensitiveSearchInLatin") {
 		DocPlus doc("abcde", 0);	// a b c d e
 		std::string finding = "B";
@@ -671,3 +719,80 @@ TEST_CASE("PerLine") {
 		REQUIRE(doc.document.AnnotationLines(2) == 0);
 	}
 }
+
+TEST_CASE("SearchPerformance", "[.][benchmark]") {
+
+	// Hidden as it is slow, run with: unitTest [benchmark]
+	// Searches about 32 MB of mostly ASCII text with the gap in the middle for text that is only at the end
+
+	std::string text;
+	const std::string line = "The quick brown fox jumps over the lazy dog \xCE\x93\xCE\xB1\xCE\xBC\xCE\xBC\xCE\xB1 0123456789\n";
+	while (text.length() < 32 * 1024 * 1024) {
+		text += line;
+	}
+	const Sci::Position expected = text.length();
+	text += "NeedleAtTheEnd\n";
+	DocPlus doc(text, CpUtf8);
+	doc.MoveGap(doc.document.Length() / 2);
+
+	SECTION("CharacterAtATime") {
+		// Visits every byte through CharAt as the case-insensitive search used to, as a baseline
+		const std::string finding = "needleattheend";
+		Catch::Timer tikka;
+		tikka.start();
+		Sci::Position location = -1;
+		for (Sci::Position pos = 0; pos < doc.document.Length(); pos++) {
+			if (MakeLowerCase(doc.document.CharAt(pos)) == finding[0]) {
+				Sci::Position lengthFinding = finding.length();
+				if (doc.document.FindText(pos, pos + lengthFinding, finding.c_str(), FindOption::None, &lengthFinding) == pos) {
+					location = pos;
+					break;
+				}
+			}
+		}
+		TimeTrace("Character at a time:       ", tikka);
+		REQUIRE(location == expected);
+	}
+
+	SECTION("CaseSensitive") {
+		const std::string finding = "NeedleAtTheEnd";
+		Sci::Position lengthFinding = finding.length();
+		Catch::Timer tikka;
+		tikka.start();
+		const Sci::Position location = doc.FindNeedle(finding, FindOption::MatchCase, &lengthFinding);
+		TimeTrace("Case-sensitive:            ", tikka);
+		REQUIRE(location == expected);
+	}
+
+	SECTION("CaseSensitiveCommonFirstByte") {
+		// Every line has many candidates for the first byte
+		const std::string finding = "e end";
+		Sci::Position lengthFinding = finding.length();
+		Catch::Timer tikka;
+		tikka.start();
+		const Sci::Position location = doc.FindNeedle(finding, FindOption::MatchCase, &lengthFinding);
+		TimeTrace("Case-sensitive, common:    ", tikka);
+		REQUIRE(location == -1);
+	}
+
+	SECTION("InsensitiveASCII") {
+		const std::string finding = "needleattheend";
+		Sci::Position lengthFinding = finding.length();
+		Catch::Timer tikka;
+		tikka.start();
+		const Sci::Position location = doc.FindNeedle(finding, FindOption::None, &lengthFinding);
+		TimeTrace("Case-insensitive ASCII:    ", tikka);
+		REQUIRE(location == expected);
+	}
+
+	SECTION("InsensitiveNonASCII") {
+		// Starts with a multi-byte character so has to fold every character
+		const std::string finding = "\xCE\xB3\xCE\xB1\xCE\xBC\xCE\xBC\xCE\xB1 X";
+		Sci::Position lengthFinding = finding.length();
+		Catch::Timer tikka;
+		tikka.start();
+		const Sci::Position location = doc.FindNeedle(finding, FindOption::None, &lengthFinding);
+		TimeTrace("Case-insensitive non-ASCII:", tikka);
+		REQUIRE(location == -1);
+	}
+}
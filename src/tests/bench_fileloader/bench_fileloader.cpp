@@ -0,0 +1,141 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "FileLoader.h"
+
+#include <QtTest>
+
+
+const qint64 MB = 1024 * 1024;
+
+// Something like source code, with an accented character every so often so the encoding matters
+static QByteArray block(bool utf8)
+{
+    const QByteArray accented = utf8 ? QByteArrayLiteral("caf\xC3\xA9") : QByteArrayLiteral("caf\xE9");
+    QByteArray block;
+
+    for (int line = 0; block.size() < 4 * MB; ++line) {
+        block += "    const QString value" + QByteArray::number(line) + " = QStringLiteral(\"" + (line % 10 == 0 ? accented : QByteArrayLiteral("coffee")) + "\");\n";
+    }
+
+    return block;
+}
+
+// Whole blocks only, so a character never gets cut in half at the end
+static bool writeFile(const QString &filePath, qint64 size, bool utf8)
+{
+    const QByteArray text = block(utf8);
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    for (qint64 written = 0; written < size; written += text.size()) {
+        if (file.write(text) != text.size()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Run with e.g. bench_fileloader "readFile:100 MB UTF-8" to only try one of them. The peak memory usage is for the
+// whole process so far, which is why the smallest files go first.
+class bench_FileLoader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void readFile_data();
+    void readFile();
+
+private:
+    QTemporaryDir dir;
+};
+
+void bench_FileLoader::initTestCase()
+{
+    QVERIFY(dir.isValid());
+}
+
+void bench_FileLoader::readFile_data()
+{
+    QTest::addColumn<qint64>("size");
+    QTest::addColumn<bool>("utf8");
+
+    const QVector<QPair<qint64, const char *>> sizes = {
+        {100 * MB, "100 MB"},
+        {1024 * MB, "1 GB"},
+        {4096 * MB, "4 GB"},
+    };
+
+    // UTF-8 is memory mapped and used as is, anything else is read in chunks and converted
+    for (const auto &size : sizes) {
+        QTest::addRow("%s UTF-8", size.second) << size.first << true;
+        QTest::addRow("%s Windows-1252", size.second) << size.first << false;
+    }
+}
+
+void bench_FileLoader::readFile()
+{
+    QFETCH(qint64, size);
+    QFETCH(bool, utf8);
+
+    const QString filePath = dir.filePath(QStringLiteral("input.txt"));
+    QVERIFY(writeFile(filePath, size, utf8));
+
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    const qint64 fileSize = file.size();
+    FileAnalyzer analyzer;
+    bool success = false;
+    qint64 bytesRead = 0;
+
+    // The document would keep everything, but that is the same no matter how the file is read so it's left out here
+    QBENCHMARK_ONCE {
+        success = FileLoader::readFile(file, [&](const char *data, qint64 length) {
+            Q_UNUSED(data);
+            bytesRead += length;
+            return true;
+        }, &analyzer);
+    }
+
+    qInfo("Read %lld MB, peak memory usage %lld MB", fileSize / MB, FileLoader::peakMemoryUsage() / MB);
+
+    file.close();
+    QFile::remove(filePath);
+
+    QVERIFY(success);
+
+    // Converting the accented characters to UTF-8 makes them longer
+    if (utf8) {
+        QCOMPARE(bytesRead, fileSize);
+    }
+    else {
+        QVERIFY(bytesRead > fileSize);
+    }
+}
+
+QTEST_APPLESS_MAIN(bench_FileLoader)
+
+#include "bench_fileloader.moc"
@@ -0,0 +1,45 @@
+# This file is part of Notepad Next.
+# Copyright 2019 Justin Dailey
+#
+# Notepad Next is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Notepad Next is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+
+
+# Reads generated files of 100 MB, 1 GB and 4 GB. They are written to the temporary directory one at a time.
+
+QT += testlib
+QT -= gui
+
+equals(QT_MAJOR_VERSION, 6): QT += core5compat
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+include(../../Config.pri)
+include(../../uchardet.pri)
+
+INCLUDEPATH += ../../NotepadNext ../../scintilla/include
+
+win32-g++:LIBS += libPsapi
+win32-msvc*:LIBS += Psapi.lib
+
+HEADERS += \
+    ../../NotepadNext/FileLoader.h
+
+SOURCES += \
+    bench_fileloader.cpp \
+    ../../NotepadNext/FileAnalyzer.cpp \
+    ../../NotepadNext/FileLoader.cpp \
+    ../../NotepadNext/Utf8Validator.cpp
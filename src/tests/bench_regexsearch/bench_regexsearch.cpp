@@ -0,0 +1,165 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "QRegexSearch.h"
+#include "Pcre2RegexSearch.h"
+
+#include <QtTest>
+
+
+using namespace Scintilla;
+
+const int TEXT_SIZE = 1024 * 1024 * 8;
+
+enum Engine {
+    QRegularExpressionEngine,
+    Pcre2Engine,
+};
+Q_DECLARE_METATYPE(Engine)
+
+// Something like source code, with the odd rare word and repeated word to find
+static std::string text()
+{
+    std::string text;
+
+    text.reserve(TEXT_SIZE + 256);
+    for (int line = 0; text.size() < static_cast<size_t>(TEXT_SIZE); ++line) {
+        text += "    const int value" + std::to_string(line) + " = compute(items[" + std::to_string(line % 97) + "], \"2023-10-16\");";
+
+        if (line % 1000 == 0) {
+            text += " // frobnicate this later";
+        }
+        else if (line % 250 == 0) {
+            text += " // the the typo";
+        }
+
+        text += "\n";
+    }
+
+    return text;
+}
+
+static RegexSearchBase *createEngine(Engine engine)
+{
+#ifdef USE_PCRE2_REGEX
+    if (engine == Pcre2Engine) {
+        return new Pcre2RegexSearch();
+    }
+#endif
+
+    Q_UNUSED(engine);
+    return new QRegexSearch();
+}
+
+// Run with e.g. "bench_regexsearch -tickcounter" or "-callgrind" for something more precise than wall time
+class bench_RegexSearch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void findAll_data();
+    void findAll();
+
+private:
+    Document *doc = Q_NULLPTR;
+};
+
+void bench_RegexSearch::initTestCase()
+{
+    const std::string contents = text();
+
+    doc = new Document(DocumentOption::Default);
+    doc->AddRef();
+    doc->SetDBCSCodePage(SC_CP_UTF8);
+    doc->SetUndoCollection(false);
+    doc->InsertString(0, contents);
+
+    // An edit in the middle leaves the gap there, the same as a document that has been worked on
+    const Sci::Position middle = doc->Length() / 2;
+    doc->InsertString(middle, "x", 1);
+    doc->DeleteChars(middle, 1);
+}
+
+void bench_RegexSearch::cleanupTestCase()
+{
+    doc->Release();
+}
+
+void bench_RegexSearch::findAll_data()
+{
+    QTest::addColumn<Engine>("engine");
+    QTest::addColumn<QByteArray>("pattern");
+    QTest::addColumn<int>("expected");
+
+    // Every line has a date, and the comments go on every 1000th and otherwise every 250th line
+    const int lines = static_cast<int>(doc->LinesTotal() - 1);
+    const int everyThousand = (lines + 999) / 1000;
+    const int every250 = (lines + 249) / 250 - everyThousand;
+
+    const QVector<QPair<Engine, const char *>> engines = {
+        {QRegularExpressionEngine, "QRegularExpression"},
+#ifdef USE_PCRE2_REGEX
+        {Pcre2Engine, "PCRE2"},
+#endif
+    };
+
+    for (const auto &engine : engines) {
+        QTest::addRow("%s literal", engine.second) << engine.first << QByteArrayLiteral("frobnicate") << everyThousand;
+        QTest::addRow("%s character class", engine.second) << engine.first << QByteArrayLiteral("[0-9]{4}-[0-9]{2}-[0-9]{2}") << lines;
+        QTest::addRow("%s backtracking", engine.second) << engine.first << QByteArrayLiteral("\\b(\\w+)\\s+\\1\\b") << every250;
+    }
+}
+
+void bench_RegexSearch::findAll()
+{
+    QFETCH(Engine, engine);
+    QFETCH(QByteArray, pattern);
+    QFETCH(int, expected);
+
+    const Sci::Position end = doc->Length();
+    int count = 0;
+
+    // A new engine each time, so anything it keeps between searches (e.g. a decoded copy) is part of the cost
+    QBENCHMARK {
+        std::unique_ptr<RegexSearchBase> search(createEngine(engine));
+        Sci::Position position = 0;
+        Sci::Position length = 0;
+
+        count = 0;
+        while (position < end) {
+            position = search->FindText(doc, position, end, pattern.constData(), true, false, false, FindOption::RegExp | FindOption::MatchCase, &length);
+
+            if (position == -1) {
+                break;
+            }
+
+            count++;
+            position = length > 0 ? position + length : doc->NextPosition(position, 1);
+        }
+    }
+
+    QCOMPARE(count, expected);
+}
+
+QTEST_APPLESS_MAIN(bench_RegexSearch)
+
+#include "bench_regexsearch.moc"
@@ -0,0 +1,106 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "SessionManifest.h"
+
+#include <QtTest>
+
+
+const int ENTRY_COUNT = 1000;
+
+// A mix of the kinds of tabs a long running session builds up, with enough view state to be realistic
+static SessionManifest manifest()
+{
+    SessionManifest manifest;
+
+    manifest.entries.reserve(ENTRY_COUNT);
+    for (int i = 0; i < ENTRY_COUNT; ++i) {
+        SessionEntry entry;
+
+        entry.type = static_cast<SessionEntry::Type>(i % 3);
+        entry.filePath = QStringLiteral("/home/user/projects/notepadnext/src/NotepadNext/folder%1/file%2.cpp").arg(i % 20).arg(i);
+        entry.fileName = QStringLiteral("New %1").arg(i);
+        entry.sessionFileName = QStringLiteral("temp_%1").arg(i);
+        entry.language = QStringLiteral("C++");
+
+        entry.view.firstVisibleLine = i * 10;
+        entry.view.currentPosition = i * 400;
+        entry.view.selections = {qMakePair<qint64, qint64>(i * 400, i * 400 + 12), qMakePair<qint64, qint64>(i * 500, i * 500)};
+        entry.view.foldedLines = {10, 42, 97, 250};
+        entry.view.bookmarkedLines = {3, 1000};
+
+        if (entry.type == SessionEntry::UnsavedFile) {
+            entry.encoding = QByteArrayLiteral("Shift_JIS");
+        }
+
+        manifest.entries.append(entry);
+    }
+
+    manifest.currentIndex = ENTRY_COUNT / 2;
+
+    return manifest;
+}
+
+// Run with e.g. "bench_sessionmanifest -tickcounter" or "-callgrind" for something more precise than wall time
+class bench_SessionManifest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void write();
+    void read();
+
+private:
+    QTemporaryDir dir;
+    QString filePath;
+};
+
+void bench_SessionManifest::initTestCase()
+{
+    QVERIFY(dir.isValid());
+
+    filePath = dir.filePath(QStringLiteral("session.nnsm"));
+}
+
+void bench_SessionManifest::write()
+{
+    const SessionManifest original = manifest();
+
+    QBENCHMARK {
+        QVERIFY(original.write(filePath));
+    }
+}
+
+void bench_SessionManifest::read()
+{
+    QVERIFY(manifest().write(filePath));
+
+    QBENCHMARK {
+        SessionManifest restored;
+
+        QVERIFY(restored.read(filePath));
+        QVERIFY(restored.entries.size() == ENTRY_COUNT);
+    }
+}
+
+QTEST_APPLESS_MAIN(bench_SessionManifest)
+
+#include "bench_sessionmanifest.moc"
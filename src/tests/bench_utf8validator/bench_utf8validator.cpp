@@ -0,0 +1,98 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Utf8Validator.h"
+
+#include <QtTest>
+
+
+Q_DECLARE_METATYPE(Utf8Validator::Implementation)
+
+const int TEXT_SIZE = 1024 * 1024 * 16;
+
+// Repeats the sample until the text is TEXT_SIZE bytes, without cutting the last character in half
+static QByteArray repeated(const QByteArray &sample)
+{
+    QByteArray text;
+
+    text.reserve(TEXT_SIZE + sample.size());
+    while (text.size() + sample.size() <= TEXT_SIZE) {
+        text.append(sample);
+    }
+
+    return text;
+}
+
+// Run with e.g. "bench_utf8validator -tickcounter" or "-callgrind" for something more precise than wall time
+class bench_Utf8Validator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void validate_data();
+    void validate();
+};
+
+void bench_Utf8Validator::validate_data()
+{
+    QTest::addColumn<Utf8Validator::Implementation>("implementation");
+    QTest::addColumn<QByteArray>("text");
+
+    const QVector<QPair<const char *, QByteArray>> texts = {
+        {"ascii", repeated(QByteArrayLiteral("The quick brown fox jumps over the lazy dog.\n"))},
+        {"mostly ascii", repeated(QByteArrayLiteral("Caf\xC3\xA9 cr\xC3\xA8me br\xC3\xBBl\xC3\xA9""e, na\xC3\xAFve fa\xC3\xA7""ade and so on.\n"))},
+        {"cjk", repeated(QByteArrayLiteral("\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE6\x96\x87\xE7\xAB\xA0\xE3\x81\xA7\xE3\x81\x99\xE3\x80\x82\n"))},
+        {"emoji", repeated(QByteArrayLiteral("\xF0\x9F\x98\x80\xF0\x9F\x8E\x89\xF0\x9F\x9A\x80 "))},
+    };
+
+    const QVector<QPair<Utf8Validator::Implementation, const char *>> implementations = {
+        {Utf8Validator::Scalar, "scalar"},
+        {Utf8Validator::Sse2, "SSE2"},
+        {Utf8Validator::Avx2, "AVX2"},
+    };
+
+    for (const auto &text : texts) {
+        for (const auto &implementation : implementations) {
+            if (Utf8Validator::isSupported(implementation.first)) {
+                QTest::addRow("%s %s", text.first, implementation.second) << implementation.first << text.second;
+            }
+        }
+    }
+}
+
+void bench_Utf8Validator::validate()
+{
+    QFETCH(Utf8Validator::Implementation, implementation);
+    QFETCH(QByteArray, text);
+
+    QBENCHMARK {
+        Utf8Validator validator(implementation);
+
+        // The same size chunks the loader hands it
+        for (qint64 offset = 0; offset < text.size(); offset += 1024 * 1024 * 4) {
+            validator.validate(text.constData() + offset, qMin<qint64>(1024 * 1024 * 4, text.size() - offset));
+        }
+
+        QVERIFY(validator.finish());
+    }
+}
+
+QTEST_APPLESS_MAIN(bench_Utf8Validator)
+
+#include "bench_utf8validator.moc"
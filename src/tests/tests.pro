@@ -0,0 +1,29 @@
+# This file is part of Notepad Next.
+# Copyright 2019 Justin Dailey
+#
+# Notepad Next is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Notepad Next is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+
+
+# Unit tests (run with "make check") and benchmarks (run by hand) for the parts of Notepad Next that do not need a GUI
+
+TEMPLATE = subdirs
+
+SUBDIRS = \
+    tst_utf8validator \
+    bench_utf8validator \
+    bench_sessionmanifest \
+    bench_regexsearch \
+    bench_fileloader \
+    tst_qregexsearch \
+    tst_filereloader
@@ -0,0 +1,126 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "FileReloader.h"
+
+#include <QtTest>
+
+
+// Each edit as its four positions one after the other, so they can be compared in one go
+using EditPositions = QList<qint64>;
+
+static QByteArray numberedLines(int count, const char *format)
+{
+    QByteArray text;
+
+    for (int i = 0; i < count; ++i) {
+        text += QByteArray(format).replace("%1", QByteArray::number(i)) + '\n';
+    }
+
+    return text;
+}
+
+class tst_FileReloader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void edits_data();
+    void edits();
+
+private:
+    bool reload(const QByteArray &oldText, const QByteArray &newText, QVector<FileReloader::Edit> &edits, QByteArray &text);
+};
+
+// Writes the new text to a file and compares it to the old text the same way reloading a document does
+bool tst_FileReloader::reload(const QByteArray &oldText, const QByteArray &newText, QVector<FileReloader::Edit> &edits, QByteArray &text)
+{
+    QTemporaryFile file;
+
+    if (!file.open() || file.write(newText) != newText.size() || !file.flush()) {
+        return false;
+    }
+
+    FileReloader *reloader = new FileReloader(file.fileName(), FileReloader::hashLines({{oldText.constData(), oldText.size()}}));
+    QEventLoop loop;
+    bool success = false;
+
+    // The reloader deletes itself once it is done, so everything has to be copied out when it finishes
+    connect(reloader, &FileReloader::finished, &loop, [&](bool ok) {
+        success = ok;
+        edits = reloader->getEdits();
+        text = reloader->getText();
+        loop.quit();
+    });
+
+    reloader->start();
+    loop.exec();
+
+    return success;
+}
+
+void tst_FileReloader::edits_data()
+{
+    QTest::addColumn<QByteArray>("oldText");
+    QTest::addColumn<QByteArray>("newText");
+    QTest::addColumn<EditPositions>("expected");
+
+    const QByteArray abc("a\nb\nc\n");
+
+    QTest::newRow("unchanged") << abc << abc << EditPositions();
+    QTest::newRow("insert") << abc << QByteArray("a\nb\nx\nc\n") << EditPositions{4, 4, 4, 6};
+    QTest::newRow("delete") << abc << QByteArray("a\nc\n") << EditPositions{2, 4, 2, 2};
+    QTest::newRow("replace") << abc << QByteArray("a\ny\nc\n") << EditPositions{2, 4, 2, 4};
+    QTest::newRow("no line ending at the end") << abc << QByteArray("a\nb\nc") << EditPositions{4, 6, 4, 5};
+    QTest::newRow("several") << QByteArray("a\nb\nc\nd\ne\n") << QByteArray("x\nb\nd\ne\ny\n") << EditPositions{0, 2, 0, 2, 4, 6, 4, 4, 10, 10, 8, 10};
+
+    // Far too many lines changed to work out each of them, so everything between the first and last change is replaced
+    const QByteArray manyOld = "first\n" + numberedLines(2000, "line %1") + "last\n";
+    const QByteArray manyNew = "first\n" + numberedLines(2000, "LINE %1") + "last\n";
+    QTest::newRow("too many changes") << manyOld << manyNew << EditPositions{6, manyOld.size() - 5, 6, manyNew.size() - 5};
+}
+
+void tst_FileReloader::edits()
+{
+    QFETCH(QByteArray, oldText);
+    QFETCH(QByteArray, newText);
+    QFETCH(EditPositions, expected);
+
+    QVector<FileReloader::Edit> edits;
+    QByteArray text;
+    QVERIFY(reload(oldText, newText, edits, text));
+    QCOMPARE(text, newText);
+
+    EditPositions positions;
+    for (const FileReloader::Edit &edit : edits) {
+        positions << edit.oldStart << edit.oldEnd << edit.newStart << edit.newEnd;
+    }
+    QCOMPARE(positions, expected);
+
+    // Making the edits from the end back to the start the way the document does has to give the new text
+    QByteArray result = oldText;
+    for (auto edit = edits.crbegin(); edit != edits.crend(); ++edit) {
+        result.replace(edit->oldStart, edit->oldEnd - edit->oldStart, text.mid(edit->newStart, edit->newEnd - edit->newStart));
+    }
+    QCOMPARE(result, newText);
+}
+
+QTEST_GUILESS_MAIN(tst_FileReloader)
+
+#include "tst_filereloader.moc"
@@ -0,0 +1,104 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "QRegexSearch.h"
+
+#include <QtTest>
+
+
+using namespace Scintilla;
+
+// Does the same as Scintilla's replace all: find, replace, then carry on searching after the replacement
+static QByteArray replaceAll(const QByteArray &text, const QByteArray &pattern, const QByteArray &replacement)
+{
+    Document *doc = new Document(DocumentOption::Default);
+    doc->AddRef();
+    doc->SetDBCSCodePage(SC_CP_UTF8);
+    doc->InsertString(0, text.constData(), text.size());
+
+    {
+        QRegexSearch search;
+        Sci::Position position = 0;
+
+        while (position < doc->Length()) {
+            Sci::Position length = 0;
+
+            position = search.FindText(doc, position, doc->Length(), pattern.constData(), true, false, false, FindOption::RegExp | FindOption::MatchCase, &length);
+            if (position == -1) {
+                break;
+            }
+
+            doc->DeleteChars(position, length);
+            doc->InsertString(position, replacement.constData(), replacement.size());
+            position += replacement.size();
+        }
+    }
+
+    const QByteArray result(doc->RangePointer(0, doc->Length()), doc->Length());
+    doc->Release();
+
+    return result;
+}
+
+class tst_QRegexSearch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void replaceAll_data();
+    void replaceAll();
+};
+
+void tst_QRegexSearch::replaceAll_data()
+{
+    QTest::addColumn<QByteArray>("text");
+    QTest::addColumn<QByteArray>("pattern");
+    QTest::addColumn<QByteArray>("replacement");
+    QTest::addColumn<QByteArray>("expected");
+
+    // Each of these looks at the text before where the search starts, which was just replaced
+    QTest::newRow("lookbehind") << QByteArray("aaaa") << QByteArray("(?<=a)a") << QByteArray("b") << QByteArray("abab");
+    QTest::newRow("word boundary") << QByteArray("aaaa") << QByteArray("\\ba") << QByteArray(" ") << QByteArray("    ");
+    QTest::newRow("start of line") << QByteArray("a\na\n") << QByteArray("^a|\\n") << QByteArray("x") << QByteArray("xxax");
+
+    // The replacement is longer than what it replaced, so there's less room before the edit in the decoded text
+    QTest::newRow("longer replacement") << QByteArray("aaaa") << QByteArray("(?<!b)a") << QByteArray("bb") << QByteArray("bbabba");
+
+    // Multibyte characters before and in the replacement, so the lookbehind has to be mapped back to bytes correctly
+    QTest::newRow("multibyte lookbehind") << QByteArray("a\xC3\xA9\xC3\xA9") << QByteArray("(?<=[a\xC3\xBC])\xC3\xA9") << QByteArray("\xC3\xBC") << QByteArray("a\xC3\xBC\xC3\xBC");
+
+    // An edit well past the start of the document, after the decoded text has been written over once already
+    QByteArray longText = QByteArray(3000, 'x') + QByteArray("\xE2\x82\xAC" "aaaa");
+    QByteArray longExpected = QByteArray(3000, 'x') + QByteArray("\xE2\x82\xAC" "abab");
+    QTest::newRow("far from the start") << longText << QByteArray("(?<=a)a") << QByteArray("b") << longExpected;
+}
+
+void tst_QRegexSearch::replaceAll()
+{
+    QFETCH(QByteArray, text);
+    QFETCH(QByteArray, pattern);
+    QFETCH(QByteArray, replacement);
+    QFETCH(QByteArray, expected);
+
+    QCOMPARE(::replaceAll(text, pattern, replacement), expected);
+}
+
+QTEST_APPLESS_MAIN(tst_QRegexSearch)
+
+#include "tst_qregexsearch.moc"
@@ -0,0 +1,283 @@
+/*
+ * This file is part of Notepad Next.
+ * Copyright 2023 Justin Dailey
+ *
+ * Notepad Next is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Notepad Next is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Notepad Next.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Utf8Validator.h"
+
+#include <QtTest>
+
+#include <tuple>
+
+
+Q_DECLARE_METATYPE(Utf8Validator::Implementation)
+
+// Every check is run against each way of skipping ASCII this build and CPU can use
+static QVector<QPair<Utf8Validator::Implementation, const char *>> supportedImplementations()
+{
+    const QVector<QPair<Utf8Validator::Implementation, const char *>> all = {
+        {Utf8Validator::Scalar, "scalar"},
+        {Utf8Validator::Sse2, "SSE2"},
+        {Utf8Validator::Avx2, "AVX2"},
+    };
+    QVector<QPair<Utf8Validator::Implementation, const char *>> supported;
+
+    for (const auto &implementation : all) {
+        if (Utf8Validator::isSupported(implementation.first)) {
+            supported.append(implementation);
+        }
+    }
+
+    return supported;
+}
+
+static qint64 firstInvalidOffset(Utf8Validator::Implementation implementation, const QByteArray &data)
+{
+    Utf8Validator validator(implementation);
+
+    validator.validate(data.constData(), data.size());
+    validator.finish();
+
+    return validator.firstInvalidOffset();
+}
+
+class tst_Utf8Validator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sequences_data();
+    void sequences();
+
+    void splitAcrossChunks_data();
+    void splitAcrossChunks();
+
+    void everyLength_data();
+    void everyLength();
+
+    void truncatedAtEnd_data();
+    void truncatedAtEnd();
+
+    void stopsAtFirstInvalidChunk();
+};
+
+void tst_Utf8Validator::sequences_data()
+{
+    QTest::addColumn<Utf8Validator::Implementation>("implementation");
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<qint64>("invalidOffset");
+
+    const QVector<std::tuple<const char *, QByteArray, qint64>> cases = {
+        {"empty", QByteArray(), -1},
+        {"ascii", QByteArrayLiteral("hello world"), -1},
+        {"2 byte", QByteArrayLiteral("\xC3\xA9"), -1},
+        {"3 byte", QByteArrayLiteral("\xE2\x82\xAC"), -1},
+        {"4 byte", QByteArrayLiteral("\xF0\x9F\x98\x80"), -1},
+        {"lowest 2 byte", QByteArrayLiteral("\xC2\x80"), -1},
+        {"lowest 3 byte", QByteArrayLiteral("\xE0\xA0\x80"), -1},
+        {"lowest 4 byte", QByteArrayLiteral("\xF0\x90\x80\x80"), -1},
+        {"highest code point", QByteArrayLiteral("\xF4\x8F\xBF\xBF"), -1},
+        {"last before surrogates", QByteArrayLiteral("\xED\x9F\xBF"), -1},
+        {"first after surrogates", QByteArrayLiteral("\xEE\x80\x80"), -1},
+
+        {"overlong 2 byte C0", QByteArrayLiteral("\xC0\x80"), 0},
+        {"overlong 2 byte C1", QByteArrayLiteral("\xC1\xBF"), 0},
+        {"overlong 3 byte", QByteArrayLiteral("\xE0\x80\x80"), 0},
+        {"overlong 3 byte highest", QByteArrayLiteral("\xE0\x9F\xBF"), 0},
+        {"overlong 4 byte", QByteArrayLiteral("\xF0\x80\x80\x80"), 0},
+        {"overlong 4 byte highest", QByteArrayLiteral("\xF0\x8F\xBF\xBF"), 0},
+        {"overlong after ascii", QByteArrayLiteral("abc\xC0\xAF"), 3},
+
+        {"high surrogate", QByteArrayLiteral("\xED\xA0\x80"), 0},
+        {"low surrogate", QByteArrayLiteral("\xED\xBF\xBF"), 0},
+        {"surrogate pair", QByteArrayLiteral("\xED\xA0\xBD\xED\xB8\x80"), 0},
+        {"surrogate after ascii", QByteArrayLiteral("ab\xED\xB0\x80"), 2},
+
+        {"past U+10FFFF", QByteArrayLiteral("\xF4\x90\x80\x80"), 0},
+        {"lead F5", QByteArrayLiteral("\xF5\x80\x80\x80"), 0},
+        {"lead F7", QByteArrayLiteral("\xF7\xBF\xBF\xBF"), 0},
+        {"lead F8", QByteArrayLiteral("\xF8\x88\x80\x80\x80"), 0},
+        {"lead FE", QByteArrayLiteral("\xFE"), 0},
+        {"lead FF", QByteArrayLiteral("\xFF"), 0},
+
+        {"lone continuation", QByteArrayLiteral("\x80"), 0},
+        {"continuation after ascii", QByteArrayLiteral("a\xBF"), 1},
+        {"extra continuation", QByteArrayLiteral("\xC3\xA9\xA9"), 2},
+        {"missing continuation", QByteArrayLiteral("\xE2\x82z"), 0},
+        {"ascii interrupting", QByteArrayLiteral("x\xF0\x9F\x98!"), 1},
+        {"truncated at end", QByteArrayLiteral("abc\xF0\x9F\x98"), 3},
+    };
+
+    for (const auto &implementation : supportedImplementations()) {
+        for (const auto &c : cases) {
+            QTest::addRow("%s %s", implementation.second, std::get<0>(c)) << implementation.first << std::get<1>(c) << std::get<2>(c);
+        }
+    }
+}
+
+void tst_Utf8Validator::sequences()
+{
+    QFETCH(Utf8Validator::Implementation, implementation);
+    QFETCH(QByteArray, data);
+    QFETCH(qint64, invalidOffset);
+
+    QCOMPARE(firstInvalidOffset(implementation, data), invalidOffset);
+}
+
+void tst_Utf8Validator::splitAcrossChunks_data()
+{
+    QTest::addColumn<Utf8Validator::Implementation>("implementation");
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<qint64>("invalidOffset");
+
+    // Long enough that the SIMD loops get a go at the ASCII on either side of the characters
+    const QByteArray padding(40, 'a');
+
+    for (const auto &implementation : supportedImplementations()) {
+        QTest::addRow("%s valid", implementation.second) << implementation.first
+            << padding + QByteArrayLiteral("\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80") + padding << qint64(-1);
+        QTest::addRow("%s overlong", implementation.second) << implementation.first
+            << padding + QByteArrayLiteral("\xE0\x9F\xBF") + padding << qint64(padding.size());
+        QTest::addRow("%s surrogate", implementation.second) << implementation.first
+            << padding + QByteArrayLiteral("\xED\xA0\x80") + padding << qint64(padding.size());
+        QTest::addRow("%s past U+10FFFF", implementation.second) << implementation.first
+            << padding + QByteArrayLiteral("\xF4\x90\x80\x80") + padding << qint64(padding.size());
+        QTest::addRow("%s bad last byte", implementation.second) << implementation.first
+            << padding + QByteArrayLiteral("\xF0\x9F\x98z") + padding << qint64(padding.size());
+    }
+}
+
+void tst_Utf8Validator::splitAcrossChunks()
+{
+    QFETCH(Utf8Validator::Implementation, implementation);
+    QFETCH(QByteArray, data);
+    QFETCH(qint64, invalidOffset);
+
+    // Every place the data could be split in two, which covers a chunk ending part way into each character
+    for (int split = 0; split <= data.size(); ++split) {
+        Utf8Validator validator(implementation);
+
+        validator.validate(data.constData(), split);
+        validator.validate(data.constData() + split, data.size() - split);
+        validator.finish();
+
+        QVERIFY2(validator.firstInvalidOffset() == invalidOffset, qPrintable(QStringLiteral("split at %1").arg(split)));
+    }
+
+    // A byte at a time
+    Utf8Validator validator(implementation);
+
+    for (int i = 0; i < data.size(); ++i) {
+        validator.validate(data.constData() + i, 1);
+    }
+    validator.finish();
+
+    QCOMPARE(validator.firstInvalidOffset(), invalidOffset);
+}
+
+void tst_Utf8Validator::everyLength_data()
+{
+    QTest::addColumn<Utf8Validator::Implementation>("implementation");
+
+    for (const auto &implementation : supportedImplementations()) {
+        QTest::newRow(implementation.second) << implementation.first;
+    }
+}
+
+void tst_Utf8Validator::everyLength()
+{
+    QFETCH(Utf8Validator::Implementation, implementation);
+
+    // The SIMD loops work on 16, 32 and 64 bytes at once, so these cover each of them along with whatever is left over
+    for (int length = 0; length <= 64; ++length) {
+        const QByteArray ascii(length, 'x');
+
+        Utf8Validator asciiValidator(implementation);
+        asciiValidator.validate(ascii.constData(), ascii.size());
+        QVERIFY(asciiValidator.finish());
+        QVERIFY(asciiValidator.isAscii());
+        QCOMPARE(asciiValidator.bytesValidated(), qint64(length));
+
+        for (int position = 0; position < length; ++position) {
+            QByteArray invalid = ascii;
+            invalid[position] = '\x80';
+
+            QVERIFY2(firstInvalidOffset(implementation, invalid) == position, qPrintable(QStringLiteral("invalid byte at %1 of %2").arg(position).arg(length)));
+
+            if (position + 1 < length) {
+                QByteArray twoByte = ascii;
+                twoByte[position] = '\xC3';
+                twoByte[position + 1] = '\xA9';
+
+                Utf8Validator validator(implementation);
+                validator.validate(twoByte.constData(), twoByte.size());
+                QVERIFY2(validator.finish(), qPrintable(QStringLiteral("2 byte character at %1 of %2").arg(position).arg(length)));
+                QVERIFY(!validator.isAscii());
+            }
+        }
+
+        // A character cut off by the end of the data
+        if (length > 0) {
+            QByteArray truncated = ascii;
+            truncated[length - 1] = '\xE2';
+
+            QVERIFY2(firstInvalidOffset(implementation, truncated) == length - 1, qPrintable(QStringLiteral("truncated character at the end of %1").arg(length)));
+        }
+    }
+}
+
+void tst_Utf8Validator::truncatedAtEnd_data()
+{
+    QTest::addColumn<Utf8Validator::Implementation>("implementation");
+
+    for (const auto &implementation : supportedImplementations()) {
+        QTest::newRow(implementation.second) << implementation.first;
+    }
+}
+
+void tst_Utf8Validator::truncatedAtEnd()
+{
+    QFETCH(Utf8Validator::Implementation, implementation);
+
+    Utf8Validator validator(implementation);
+
+    // Nothing is wrong yet since the rest of the character could still be on its way
+    QVERIFY(validator.validate("abc\xF0\x9F", 5));
+    QVERIFY(validator.isValid());
+
+    QVERIFY(!validator.finish());
+    QCOMPARE(validator.firstInvalidOffset(), qint64(3));
+}
+
+void tst_Utf8Validator::stopsAtFirstInvalidChunk()
+{
+    Utf8Validator validator;
+
+    QVERIFY(!validator.validate("a\xFF", 2));
+    QCOMPARE(validator.firstInvalidOffset(), qint64(1));
+
+    // Later chunks don't change where it went wrong
+    QVERIFY(!validator.validate("\xC0\x80", 2));
+    QCOMPARE(validator.firstInvalidOffset(), qint64(1));
+
+    QVERIFY(!Utf8Validator::isValid("\xED\xA0\x80", 3));
+    QVERIFY(Utf8Validator::isValid("\xED\x9F\xBF", 3));
+}
+
+QTEST_APPLESS_MAIN(tst_Utf8Validator)
+
+#include "tst_utf8validator.moc"